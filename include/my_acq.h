@@ -0,0 +1,32 @@
+#pragma once
+
+#include <stdint.h>
+#include "my_hal.h"
+
+// 传感器采集流水线：Wire0/Wire1 各一个采集任务并行读取，
+// 在下一控制周期开始前备好带时间戳的快照，控制任务只做交接
+
+// 启动两路总线采集任务
+void my_acq_start();
+bool my_acq_running();
+
+// 改由 MPU6050 数据就绪中断触发采集并作为控制节拍，IMU 输出率设为 1/period_us
+bool my_acq_use_drdy(int pin, uint32_t period_us);
+bool my_acq_drdy_active();
+
+// 中断丢失时退回定时器节拍
+void my_acq_drdy_stop();
+
+// 预约下一帧：定时器模式在 due_us（micros）之前 ACQ_LEAD_US（不超过一个周期）启动两路并行读取，
+// 数据就绪模式则等待下一次中断
+void my_acq_schedule(uint32_t due_us);
+
+// 取本周期快照：有在途帧则等待其完成（最多 ACQ_WAIT_US，定时器模式不超过半个周期；超时沿用上一帧），否则同步读取
+void my_acq_take(hal_sense_snapshot &out);
+
+// 统计：已交付的预取帧与等待超时次数
+uint32_t my_acq_frames();
+uint32_t my_acq_misses();
+// 按当前控制周期缩放后的预取提前量与等待上限（us）
+uint32_t my_acq_lead_us();
+uint32_t my_acq_wait_us();
@@ -0,0 +1,21 @@
+#pragma once
+#include "my_config.h"
+#include "my_hal.h"
+
+// Mahony AHRS：复位滤波器，下一帧用加速度重新初始化姿态
+void ahrs_reset();
+
+// 融合一帧 IMU 原始数据，结果写入 robot.imu（角度 deg，角速度 deg/s）；dt 为采样间隔 (s)
+void ahrs_update(robot_state &robot, const hal_imu_sample &s, float dt);
+
+// 滤波器内部状态（四元数与积分项），供热重启保存/恢复
+struct ahrs_state
+{
+    float q0, q1, q2, q3;
+    float eIx, eIy, eIz;
+};
+
+// 尚未初始化时返回 false
+bool ahrs_get_state(ahrs_state &out);
+// 下一帧直接在此状态上融合，不再用加速度重新初始化
+void ahrs_set_state(const ahrs_state &s);
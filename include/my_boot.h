@@ -0,0 +1,31 @@
+#pragma once
+
+#include <stdint.h>
+
+// 启动时间线：各初始化阶段的起止时刻（上电后 ms），经 WS 的 boot 消息上报
+
+enum class BootStage : uint8_t
+{
+    Net,     // WiFi/AP 与 Web 服务
+    Screen,  // 开机动画（屏幕任务内）
+    Imu,     // MPU6050 配置与陀螺零偏采样
+    MotorL,  // 左电机 initFOC
+    MotorR,  // 右电机 initFOC（与左电机并行）
+    Control, // 控制任务开始运行
+    Balance, // 首次进入平衡状态
+    Count
+};
+
+struct boot_span
+{
+    uint32_t start_ms; // 0 表示尚未开始
+    uint32_t end_ms;   // 0 表示尚未结束
+};
+
+void boot_begin(BootStage stage);
+void boot_end(BootStage stage);
+// 瞬时事件：起止相同
+void boot_mark(BootStage stage);
+
+boot_span boot_get(BootStage stage);
+const char *boot_stage_name(BootStage stage);
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "my_motion.h"
+
+// 全速率曲线采集：控制任务每周期把曲线通道压入环形缓冲，网络任务成批取走按列打包下发，
+// 避免 ext_ms 定时采样造成的混叠
+
+// 采集列；前 CHART_PLOT_CHANNELS 列为曲线通道，其顺序即批量帧中的列顺序
+enum ChartChannel : uint8_t
+{
+    CHART_ANG_TAR,
+    CHART_PITCH,
+    CHART_SPD_TAR,
+    CHART_SPD_NOW,
+    CHART_TORQUE_L,
+    CHART_TORQUE_R,
+    CHART_SPEED_L,
+    CHART_SPEED_R,
+    CHART_GYRO_Y,
+    CHART_PLOT_CHANNELS,
+    // 以下只用于遥测订阅的聚合
+    CHART_ROLL = CHART_PLOT_CHANNELS,
+    CHART_YAW,
+    CHART_ACC_Y,
+    CHART_DZ_L,
+    CHART_DZ_R,
+    CHART_BATT_V,
+    CHART_CHANNELS
+};
+
+struct chart_sample
+{
+    uint32_t seq;  // robot_frame::seq，相邻样本不连续表示有丢失
+    uint32_t t_ms;
+    float v[CHART_CHANNELS];
+};
+
+// 网络侧（与 chart_pop 同一任务调用）：有订阅者时打开；关闭后控制任务不再写入
+void chart_capture_enable(bool on);
+bool chart_capture_enabled();
+
+// 控制任务侧：压入本周期样本，缓冲满时丢弃并计数
+void chart_push(const robot_frame &f);
+
+// 网络侧：取出最多 max 个序号连续的样本，返回个数
+size_t chart_pop(chart_sample *out, size_t max);
+// 因缓冲满被丢弃的样本数
+uint32_t chart_overflows();
+
+const char *chart_channel_name(uint8_t ch);
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <stdint.h>
+#include "my_config.h"
+
+// 网络 → 控制任务的指令邮箱：WebSocket 回调只入队，控制任务在 my_motion_update 开头统一生效，
+// robot 只剩控制任务一个写者。离散指令走有界单生产者队列，摇杆走只保留最新值的槽位
+// 生产者必须是同一个任务（AsyncTCP），消费者只有控制任务
+
+enum class CmdType : uint8_t
+{
+    Run,              // flag
+    FallCheck,        // flag
+    OffgroundProtect, // flag
+    EStop,            // flag
+    CalibImu,
+    CalibDeadzone,
+    SetPid,           // pid
+    PitchZero,        // value
+    TorqueLimit,      // value
+    TestMode,         // flag
+    MotorMode,        // mode
+    MotorOut,         // l, r（仅测试模式生效）
+    RestartImu,       // 硬件重启：控制任务取走后串行执行
+    RestartMotor,
+    RealignMotor,     // 清除对齐存档后重启电机
+};
+
+// 三组 PID 的完整参数（入队前已与当前值合并）
+struct cmd_pid
+{
+    float ang_p, ang_i, ang_d;
+    float spd_p, spd_i, spd_d;
+    float yaw_p, yaw_i, yaw_d;
+};
+
+struct motion_cmd
+{
+    CmdType type;
+    uint32_t t_us; // 入队时刻，用于统计指令到生效的延迟
+    union
+    {
+        bool flag;
+        float value;
+        MotorControlMode mode;
+        struct
+        {
+            float l, r;
+        } out;
+        cmd_pid pid;
+    };
+};
+
+// 需要控制任务在周期外执行的硬件操作
+enum : uint8_t
+{
+    CMD_HW_RESTART_IMU = 1 << 0,
+    CMD_HW_RESTART_MOTOR = 1 << 1,
+    CMD_HW_REALIGN_MOTOR = 1 << 2,
+};
+
+// 生产者侧：队列满时返回 false，指令被丢弃
+bool cmd_post(motion_cmd c);
+bool cmd_post_flag(CmdType type, bool flag);
+bool cmd_post_value(CmdType type, float value);
+// 摇杆：覆盖最新值，不占队列
+void cmd_post_joy(float x, float y);
+
+// 当前 PID 参数（仅控制任务写 robot.*_pid，且只来自本队列，网络侧读取用于合并与回显）
+cmd_pid cmd_pid_from(const robot_state &robot);
+
+// 消费者侧：应用所有待处理指令，返回本次应用条数
+int cmd_drain(robot_state &robot);
+// 取走并清除累积的硬件请求位
+uint8_t cmd_take_hw_requests();
+
+// 统计
+uint32_t cmd_applied();
+uint32_t cmd_dropped();
@@ -1,6 +1,16 @@
 #pragma once
 
+#ifdef ARDUINO
 #include <Arduino.h>
+#else
+// 主机（native）构建：运动库不依赖 Arduino 核心
+#include <stdint.h>
+#include <stddef.h>
+#include <math.h>
+#ifndef PI
+#define PI 3.1415926535897932384626433832795
+#endif
+#endif
 #include "my_motion_state.h"
 
 /********** I2C **********/
@@ -9,12 +19,26 @@
 #define I2C_SDA_2 1     //screen+右as5600
 #define I2C_SCL_2 2
 #define I2C_FREQUENCY 400000
+#define I2C1_BG_CHUNK 8          // Wire1 后台（屏幕）单块最多数据字节，决定编码器读取的最坏等待
+#define I2C1_GUARD_US 20         // 后台块须在下一次编码器读取前至少这么久结束
+#define I2C1_BG_STARVE_US 5000   // 后台等不到空档超过此时长后，在下一次编码器读取刚结束时放行 1 字节
+#define I2C1_TXN_OVERHEAD_US 60  // 单次 Wire 事务的驱动固定开销（命令链、中断与任务切换），按实机 i2c1_wait 统计校准
+
+/********** MPU6050 **********/
+#define MPU_DLPF_CFG 0           // 数字低通：0=256Hz 1=188Hz 2=98Hz 3=42Hz 4=20Hz 5=10Hz 6=5Hz（陀螺带宽）
+#define MPU_GYRO_FS 3            // 陀螺量程：0=±250 1=±500 2=±1000 3=±2000 dps，摔倒瞬间可超 500dps
+#define MPU_ACCEL_FS 1           // 加速度量程：0=±2 1=±4 2=±8 3=±16 g
+#define MPU_SMPLRT_DIV 0         // 输出率 = 陀螺采样率 / (1 + DIV)
+#define MPU_GYRO_CALIB_SAMPLES 1000 // 上电陀螺零偏采样帧数（约 1ms/帧）
+#define MPU_INT_PIN -1           // MPU6050 INT 所接 GPIO；-1 表示未接线，控制任务按定时器节拍运行
+#define MPU_DRDY_TIMEOUT_MS 20   // 数据就绪中断超过此时长未到达则退回定时器节拍
 
 /********** SCREEN (SSD1306) **********/
 #define SCREEN_WIDTH 128
 #define SCREEN_HEIGHT 64
 #define SCREEN_REFRESH_TIME 100 // ms
 #define SCREEN_I2C_ADDRESS 0x3C // 标签0x78，7bit地址0x3C
+#define SCREEN_EXT_HOLD_MS 1000 // 外部帧停止后多久恢复状态页
 
 /********** Power **********/
 #define BAT_PIN 6
@@ -35,6 +59,31 @@
 #define DRIVER2_IN2 8
 #define DRIVER2_IN3 7
 
+/********** 控制调度 **********/
+#define CONTROL_PERIOD_US 2000      // 平衡环周期 (us)，esp_timer 驱动，不受 RTOS tick 限制
+#define CONTROL_PERIOD_MIN_US 250   // 短于 ACQ_LEAD_US + ACQ_WAIT_US 时采集流水线按周期缩放，见 my_acq.cpp
+#define CONTROL_PERIOD_MAX_US 20000
+
+/********** 网络 **********/
+#define NET_MAX_CLIENTS 8          // 同时在线的 WS 客户端上限，超出时关闭最早的连接
+#define NET_CLIENT_QUEUE_SOFT 4    // 客户端发送队列积压达到此深度后丢弃周期帧
+#define NET_CLIENT_STALL_MS 5000   // 持续积压超过此时长的客户端被断开
+#define CMD_QUEUE_LEN 16           // 网络指令队列深度（2 的幂），满时丢弃新指令
+#define CHART_RING_LEN 256         // 全速率曲线缓冲（2 的幂），500Hz 下约 0.5s
+#define CHART_BATCH 50             // 每个批量帧的最大样本数
+#define TELEM_STREAM_MS 20         // 取采集环、分发批量帧与订阅的周期
+#define TELEM_SUB_MAX_CH 16        // 单个订阅最多通道数
+
+/********** FOC 换相任务 **********/
+// 换相周期 (us)，设为 0 则退回平衡环内换相。每拍两次 AS5600 角度读（400kHz 下各约 120~150us，
+// 分属 Wire0/Wire1），再算上 Wire0 上平衡环的 14 字节 IMU 读（约 400us），两路 I2C 编码器约 1kHz 为上限
+#define FOC_LOOP_US 1000
+#define FOC_TASK_CORE 1       // 与平衡环分核，避免互相抢占
+#define FOC_TASK_STACK 4096
+#define FOC_NUDGE_V 1.5f          // 对齐存档校验：试探力矩电压 (V)
+#define FOC_NUDGE_MS 60           // 每个方向的试探时长 (ms)
+#define FOC_NUDGE_MIN_RAD 0.005f  // 转子须随之转过的最小角度 (rad)
+
 /********** RGB **********/
 #define RGB_PIN 3
 #define RGB_COUNT 5
@@ -126,7 +175,8 @@ struct fallen_state
 
 struct robot_state
 {
-    int dt_ms;
+    uint32_t dt_us; // 控制周期 (us)
+    float dt;       // 本周期间隔 (s)，由调度按节拍给出
     int data_ms;
 
     bool run;
@@ -198,6 +248,7 @@ struct robot_state
 /********** 传感器地址 **********/
 #define ADDR_MPU6050 0x68
 #define ADDR_AS5600  0x36
+#define AS5600_REG_STATUS 0x0B // 磁铁状态：MD/ML/MH
 
 /********** Mahony AHRS 姿态融合 **********/
 #define MAHONY_KP           2.0f    // 加速度计比例校正增益
@@ -218,6 +269,31 @@ struct robot_state
 /********** I2C 故障检测 **********/
 #define I2C_FAULT_CHECK_MS  250     // I2C 设备存活检测周期（ms）
 
+/********** 持久化 **********/
+#define STORAGE_PWD_MAX         64      // 配置中各文本字段的最大长度（不含结尾 0）
+#define STORAGE_NAME_MAX        32
+#define STORAGE_SSID_MAX        32
+#define STORAGE_WIFI_PASS_MAX   64
+#define STORAGE_COALESCE_MS     200     // 最后一次写入后静默多久再提交
+#define STORAGE_MIN_INTERVAL_MS 2000    // 两次提交的最小间隔，限制 flash 擦写
+
+/********** 热重启 **********/
+#define WARM_MEM_BYTES      128     // 复位后保留的内存块大小（RTC 无初始化段）
+#define WARM_SAVE_MS        100     // 控制任务刷新保留区的周期
+#define WARM_MAX_CHAIN      3       // 连续热启动次数上限，超过视为复位循环，退回冷启动
+#define WARM_STABLE_MS      10000U  // 持续运行超过该时长后清零连续热启动计数
+#define WARM_QUAT_TOL       0.01f   // 取回的四元数模长与 1 的允许偏差
+#define WARM_GYRO_BIAS_MAX  20.0f   // 取回的陀螺零偏上限（deg/s，MPU6050 零偏规格 ±20）
+#define WARM_DZ_MAX         3.0f    // 取回的死区上限（与标定扫描的最大力矩一致）
+#define WARM_PITCH_ZERO_MAX 15.0f   // 取回的 pitch 零点绝对值上限（deg）
+
+/********** 传感器采集流水线 **********/
+#define ACQ_READ_US         400     // 实测一帧读取耗时（IMU 14 字节 @400kHz 加驱动开销）
+#define ACQ_LEAD_US         600     // 下一控制周期开始前多久启动预取（us），需覆盖 ACQ_READ_US 与应答检测；不超过一个周期
+#define ACQ_WAIT_US         400     // 控制周期等待在途快照的上限（us，esp_timer 计时，与 RTOS tick 无关）；定时器模式不超过半个周期
+#define ACQ_MISS_FAULT      10      // 连续取不到快照的周期数，超过即视为传感器失联
+#define ACQ_TASK_STACK      3072
+
 /********** 姿态零点自适应 **********/
 #define ZERO_ADAPT_DEADBAND_DEG 2.0f   // 静止判定俯仰阈值
 #define ZERO_ADAPT_GYRO_DPS     8.0f   // 静止判定角速度阈值
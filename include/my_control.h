@@ -3,6 +3,9 @@
 
 // 运行时力矩总幅限制（可通过网络配置动态调整）
 extern float torque_limit;
+// 运行时前馈增益，默认取 GRAVITY_FF_GAIN / ACCEL_FF_GAIN（便于在线/仿真整定）
+extern float gravity_ff_gain;
+extern float accel_ff_gain;
 
 
 void control_reset(robot_state &robot);
@@ -1,11 +1,59 @@
 #pragma once
 
 #include "SimpleFOC.h"
+#include "my_hal.h"
 
 extern BLDCMotor motor_1;
 extern BLDCMotor motor_2;
 extern MagneticSensorI2C sensor_1;
 extern MagneticSensorI2C sensor_2;
+extern BLDCDriver3PWM driver_1;
+extern BLDCDriver3PWM driver_2;
 
+// 初始化驱动与编码器并对齐；有对齐存档且校验通过时跳过扫描对齐（见 FOC_NUDGE_*）
 void my_motor_init();
-void my_motor_update();
+// 清除对齐存档，下次 my_motor_init 强制完整对齐
+void my_motor_forget_alignment();
+
+// 平衡环 → 换相任务：最新力矩/速度/位置目标与供电参数
+struct foc_targets
+{
+    HalMotorLoop loop;
+    float L;
+    float R;
+    float supply_v;
+    float voltage_limit;
+};
+
+// 换相任务 → 平衡环：最近一次编码器读数（整圈 + 机械角，避免长时间运行后 float 精度下降）
+struct foc_feedback
+{
+    int32_t rot_L;
+    int32_t rot_R;
+    float mech_L;
+    float mech_R;
+    uint32_t ts_us;
+    uint32_t loops; // 累计换相次数
+};
+
+// 启动独立的高频换相任务（FOC_LOOP_US 为 0 时不启动）
+void my_foc_start_task();
+bool my_foc_task_running();
+
+// 换相任务实测：节拍间隔超过 1.5 个周期按漏掉的拍数计入 overruns
+struct foc_stats
+{
+    uint32_t loops;
+    uint32_t overruns;
+    float rate_hz;        // 最近约 1s 的实测换相频率
+    uint32_t busy_us;     // 最近一次换相耗时
+    uint32_t max_busy_us;
+};
+foc_stats my_foc_get_stats();
+
+// 无锁交接：平衡环写目标，换相任务写反馈
+void my_foc_set_targets(const foc_targets &t);
+bool my_foc_get_feedback(foc_feedback &out);
+
+// 未启用换相任务时，由平衡环直接执行一次换相
+void my_foc_step_inline(const foc_targets &t);
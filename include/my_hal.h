@@ -0,0 +1,68 @@
+#pragma once
+
+#include <stdint.h>
+
+// 硬件抽象层：运动库只经由这里访问时钟、IMU、编码器与电机
+// 固件实现：src/my_hardware_lib/my_hal_esp32.cpp
+// 主机实现：src/my_native_lib/my_hal_native.cpp（可注入的假设备）
+
+/********** 时钟 **********/
+uint32_t hal_millis();
+uint32_t hal_micros();
+
+// 高分辨率计数器（CPU 周期），用于控制周期剖析
+uint32_t hal_cycles();
+uint32_t hal_cycles_per_us();
+
+/********** IMU **********/
+struct hal_imu_sample
+{
+    float ax, ay, az; // 加速度 (g)
+    float gx, gy, gz; // 角速度 (deg/s)
+};
+
+// 读取一帧 IMU 原始数据，t_us 为采样时刻
+void hal_imu_read(hal_imu_sample &out, uint32_t &t_us);
+
+/********** 编码器 **********/
+// 刷新左右轮编码器并返回角速度 (rad/s)
+void hal_wheel_read(float &wL, float &wR);
+
+/********** 采样快照 **********/
+// 单个控制周期用到的全部传感器数据，附采样时刻
+struct hal_sense_snapshot
+{
+    hal_imu_sample imu;
+    uint32_t imu_us;   // IMU 读完时刻 (us)
+    float wL, wR;      // 左右轮角速度 (rad/s)
+    uint32_t wheel_us; // 轮速对应时刻 (us)
+    bool alive;        // 最近一次应答检测结果
+};
+
+// 取本周期快照；固件上由两路 I2C 并行预取，未就绪时退化为同步读取
+void hal_sense_read(hal_sense_snapshot &out);
+
+/********** 电机 **********/
+enum class HalMotorLoop
+{
+    Torque,   // 电压力矩模式，目标单位 V
+    Velocity, // 速度闭环，目标单位 rad/s
+    Angle     // 位置闭环，目标单位 rad
+};
+
+// 更新驱动供电电压与输出电压上限
+void hal_motor_set_supply(float supply_v, float voltage_limit);
+
+// 下发左右电机目标；固件上由独立换相任务按 FOC_LOOP_US 执行
+void hal_motor_output(HalMotorLoop loop, float target_L, float target_R);
+
+/********** 传感器存活 **********/
+// MPU6050 与左右 AS5600 均应答时返回 true
+bool hal_sensors_alive();
+
+/********** 热重启保留区 **********/
+// WARM_MEM_BYTES 字节、复位后内容保留的内存（固件上位于 RTC 慢速内存的无初始化段）；
+// 冷启动时为随机值，使用者须自行校验
+uint8_t *hal_warm_mem();
+// 本次复位是否保留了上次运行的内存（软件复位、看门狗、异常）
+bool hal_warm_reset();
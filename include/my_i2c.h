@@ -6,3 +6,34 @@
 #define Wire0 Wire
 
 void my_i2c_init();
+
+// Wire1 仲裁：右 AS5600（控制环）与屏幕共用一路总线。
+// 单次传输的原子性由 Wire 自身的锁保证，这里只负责优先级：
+// 控制侧事务严格优先，屏幕写入拆成小块，只在两次编码器读取之间的空档发出，
+// 控制侧最坏只需等一个小块传完
+enum class I2cDev : uint8_t
+{
+    As5600R, // 控制侧
+    Screen,  // 后台
+    Count
+};
+
+// 控制侧事务前后调用，可在多个任务中使用（彼此互斥）。
+// 按固定节拍发生的编码器读取用 _periodic 版本，后台空档只按它们的间隔估计；
+// 应答检测等零星事务用普通版本，不影响估计
+void i2c1_hi_begin(I2cDev dev);
+void i2c1_hi_begin_periodic(I2cDev dev);
+void i2c1_hi_end();
+
+// 后台写：每块前重复 prefix（如 SSD1306 控制字节），块大小按当前空档与 I2C1_BG_CHUNK 取小
+void i2c1_bg_write(I2cDev dev, uint8_t addr, uint8_t prefix, const uint8_t *data, size_t len);
+
+// 取得总线的等待时间统计（us）
+struct i2c_wait_stats
+{
+    uint32_t n;
+    uint32_t avg_us;
+    uint32_t max_us;
+};
+i2c_wait_stats i2c1_wait_stats(I2cDev dev);
+const char *i2c_dev_name(I2cDev dev);
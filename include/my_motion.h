@@ -1,6 +1,42 @@
 #pragma once
 #include "my_config.h"
+#include "my_hal.h"
 
 extern robot_state robot;
+
+// 跨核只读快照：my_motion_update 末尾发布一次，遥测/屏幕/记录只读这里，不直接访问 robot
+struct robot_frame
+{
+    uint32_t seq;  // 发布序号（控制周期计数）
+    uint32_t t_ms; // 发布时刻
+    uint32_t dt_us; // 控制周期 robot.dt_us
+    MotionState state;
+    bool fallen;
+    bool wel_up;
+    bool drv_fault;
+    bool lowbat_warn;
+    float pitch;   // robot.ang.now
+    float roll;    // robot.imu.anglex
+    float yaw;     // robot.yaw.now
+    float pitch_raw; // robot.imu.angley（未扣零点）
+    float pitch_zero; // robot.pitch_zero（含运行中的自适应修正）
+    float gyro_y;
+    float ang_tar;
+    float spd_tar;
+    float spd_now;
+    float wL, wR;
+    float tor_base, tor_L, tor_R;
+    float dzL, dzR;
+    float torque_limit;
+    float batt_v;
+};
+
 void my_motion_init();
-void my_motion_update();
+// 以本周期传感器快照推进估计、状态机与控制
+void my_motion_update(const hal_sense_snapshot &snap);
+
+// 读取最近一帧快照（单写者序列锁，读端自旋到一致为止）；尚未发布时返回 false
+bool my_motion_snapshot(robot_frame &out);
+
+// 将 robot.tor 按当前状态/模式映射为电机目标并下发
+void my_motor_update();
@@ -1,7 +1,56 @@
 #pragma once
-#include <MPU6050_tockn.h>
+#include <Wire.h>
+#include "my_hal.h"
+
+// 片内 MPU6050 驱动：单次 14 字节突发读取加速度/温度/角速度，量程与数字低通可配置
+
+// 数字低通带宽（CONFIG.DLPF_CFG，按陀螺带宽命名；Hz256 时陀螺内部采样 8kHz）
+enum class MpuDlpf : uint8_t
+{
+    Hz256 = 0,
+    Hz188,
+    Hz98,
+    Hz42,
+    Hz20,
+    Hz10,
+    Hz5
+};
+
+enum class MpuGyroRange : uint8_t
+{
+    Dps250 = 0,
+    Dps500,
+    Dps1000,
+    Dps2000
+};
+
+enum class MpuAccelRange : uint8_t
+{
+    G2 = 0,
+    G4,
+    G8,
+    G16
+};
+
+struct mpu6050_config
+{
+    MpuDlpf dlpf;
+    MpuGyroRange gyro_range;
+    MpuAccelRange accel_range;
+    uint8_t sample_div; // 输出率 = 陀螺内部采样率 / (1 + sample_div)
+};
+
+// 唤醒并写入量程/低通配置，总线无应答时返回 false
+bool mpu6050_begin(TwoWire &wire, const mpu6050_config &cfg);
+
+// 按 rate_hz 重设输出分频并打开数据就绪中断（INT 引脚每帧一个高电平脉冲）
+bool mpu6050_enable_data_ready(uint16_t rate_hz);
+
+// 突发读取一帧并换算为 g 与 deg/s（已扣除上电陀螺零偏）；t_us 为发起读取时刻
+// 读取失败时返回 false，out 保留上一帧
+bool mpu6050_read(hal_imu_sample &out, uint32_t &t_us);
+
+// 静止平均 samples 帧求陀螺零偏
+void mpu6050_calc_gyro_offsets(uint16_t samples);
 
-extern MPU6050 mpu6050;
-// MPU6050实例
 void my_mpu6050_init();
-void my_mpu6050_update();
\ No newline at end of file
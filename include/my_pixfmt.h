@@ -0,0 +1,13 @@
+#pragma once
+
+#include <stdint.h>
+
+// 外部图像到 SSD1306 页格式的转换：dst 按页逐行排列，每字节纵向 8 像素、LSB 在上，
+// 与 Adafruit_SSD1306 显存布局一致（无旋转）；w、h 须为 8 的倍数，dst 至少 w*h/8 字节
+
+// 行优先 1bpp（每行 w/8 字节，MSB 为最左像素），按 8x8 块做 64 位位矩阵转置
+void pix_mono_to_pages(const uint8_t *src, uint8_t *dst, uint16_t w, uint16_t h);
+
+// 小端 rgb565 按亮度二值化；dither 为 false 时阈值与旧的逐像素实现一致，
+// 为 true 时改用 4x4 有序抖动（Bayer）保留灰阶
+void pix_rgb565_to_pages(const uint8_t *src, uint8_t *dst, uint16_t w, uint16_t h, bool dither);
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <stdint.h>
+
+// 控制周期剖析：按阶段统计 CPU 周期耗时直方图，控制任务写、网络任务读
+
+enum class ProfStage : uint8_t
+{
+    Imu,    // 取传感器快照 + AHRS
+    Bat,    // my_bat_update
+    Motion, // my_motion_update
+    Motor,  // my_motor_update
+    Busy,   // 单周期总工作时间
+    Period, // 相邻两次周期开始的间隔（调度抖动）
+    Cmd,    // 网络指令从入队到被控制任务应用的延迟
+    Count
+};
+
+struct prof_summary
+{
+    uint32_t count;
+    float last_us;
+    float min_us;
+    float max_us;
+    float avg_us;
+    float p50_us;
+    float p99_us;
+};
+
+// 直方图：PROF_BINS 个 PROF_BIN_US 宽的桶，末桶收纳溢出
+#define PROF_BIN_US 16
+#define PROF_BINS   160
+
+// 当前计数值（CPU 周期）
+uint32_t prof_now();
+
+// 控制任务侧：记录某阶段耗时（周期数）
+void prof_add(ProfStage stage, uint32_t cycles);
+// 控制任务侧：一个周期结束，busy 超过 budget_us 计为一次超时
+void prof_cycle_end(uint32_t busy_cycles, uint32_t budget_us);
+
+// 读取侧
+prof_summary prof_get(ProfStage stage);
+uint32_t prof_overruns();
+const char *prof_stage_name(ProfStage stage);
+
+// 请求清零：由控制任务在下一次 prof_add 时执行，避免跨核写冲突
+void prof_reset();
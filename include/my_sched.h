@@ -0,0 +1,22 @@
+#pragma once
+
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+
+// 控制周期调度：esp_timer 以微秒周期唤醒控制任务，不受 RTOS tick 限制；
+// 也可改由外部节拍（IMU 数据就绪中断）驱动
+
+// 创建周期定时器，period_us 限制在 CONTROL_PERIOD_MIN_US ~ CONTROL_PERIOD_MAX_US
+void my_sched_start(TaskHandle_t task, uint32_t period_us);
+uint32_t my_sched_period_us();
+
+// 阻塞到下一拍，返回自上次返回以来经过的节拍数（>1 表示有拍被跳过）
+// 外部节拍模式下超过 MPU_DRDY_TIMEOUT_MS 未到达返回 0
+uint32_t my_sched_wait();
+
+// 定时器模式下一拍的预定时刻（micros），供采集流水线预取
+uint32_t my_sched_next_us();
+
+// 切换节拍来源：true 时停掉定时器，由 my_sched_tick_from_isr 驱动
+void my_sched_use_external(bool external);
+void my_sched_tick_from_isr(BaseType_t *woken);
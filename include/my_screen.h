@@ -8,9 +8,20 @@
 #include "my_bat.h"
 #include "my_i2c.h"
 
+// 只做面板初始化与清屏，开机动画由 my_screen_play_boot 在屏幕任务中播放
 void my_screen_init();
+void my_screen_play_boot();
+// 屏幕任务调用：登记任务句柄，外部帧到达时唤醒它提前刷新
+void my_screen_attach(TaskHandle_t task);
 void my_screen_update();
+// 最近一次刷新实际写入面板的显存字节数（只发送变化的页内列区间）
+uint32_t my_screen_tx_bytes();
 
-// 接收外部屏幕数据，mode: "mono" (1bpp) 或 "rgb565"
+// 接收外部屏幕数据，mode: "mono" (1bpp)、"rgb565"（阈值）或 "rgb565_dither"（有序抖动）
 // data 指向编码后的字节数组，len 需匹配 width*height/8 或 width*height*2
 void my_screen_draw_buffer(const uint8_t *data, size_t len, uint16_t width, uint16_t height, const char *mode);
+
+// 外部帧直写：data 为 SSD1306 页格式（每字节纵向 8 像素、LSB 在上），
+// 覆盖 page 起 pages 页、col 起 cols 列的矩形，按页逐行排列；区域外保留上一外部帧内容
+// 可在 WS 回调中调用，不分配内存；越界或屏幕未就绪返回 false
+bool my_screen_blit_pages(uint8_t page, uint8_t pages, uint8_t col, uint8_t cols, const uint8_t *data);
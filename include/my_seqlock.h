@@ -0,0 +1,52 @@
+#pragma once
+
+#include <atomic>
+#include <string.h>
+
+// 单写者序列锁：写端无等待，读端拿到的一定是同一次 store 的完整数据
+// 读端与写端可在不同核/不同优先级；同核高优先级读者应使用 try_load，失败时沿用旧值
+template <typename T>
+class seqlock
+{
+public:
+    void store(const T &v)
+    {
+        const uint32_t s = seq_.load(std::memory_order_relaxed);
+        seq_.store(s + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        memcpy(&data_, &v, sizeof(T));
+        std::atomic_thread_fence(std::memory_order_release);
+        seq_.store(s + 2, std::memory_order_release);
+    }
+
+    // 单次尝试，写入进行中或被打断时返回 false
+    bool try_load(T &out) const
+    {
+        const uint32_t s0 = seq_.load(std::memory_order_acquire);
+        if (s0 & 1U)
+            return false;
+        memcpy(&out, &data_, sizeof(T));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return seq_.load(std::memory_order_relaxed) == s0;
+    }
+
+    // 自旋直至读到一致数据；仅在写者不会被读者阻塞时使用
+    T load() const
+    {
+        T out;
+        while (!try_load(out))
+        {
+        }
+        return out;
+    }
+
+    // 已完成的 store 次数，0 表示尚未发布过
+    uint32_t version() const
+    {
+        return seq_.load(std::memory_order_acquire) >> 1;
+    }
+
+private:
+    std::atomic<uint32_t> seq_{0};
+    T data_{};
+};
@@ -1,17 +1,125 @@
 #pragma once
 
+#include <stddef.h>
+#include <stdint.h>
+#include "my_config.h"
+#include "my_cmd.h"
+
+#ifdef ARDUINO
 #include <Arduino.h>
+#endif
+
+// 持久化配置：全部参数打包成一个带版本与 CRC 的 blob，存于单个 NVS 键。
+// 启动时由 storage_start 读入内存一次，之后的读取都不访问 flash；
+// 写入只改内存副本（不阻塞，可在控制任务中调用），由持久化任务合并、限频后整体落盘，
+// 一次更新要么整体生效要么整体不生效
+
+// present 位：对应字段组保存过，未置位的字段由各模块沿用默认值
+enum : uint32_t
+{
+    STORAGE_CALIB = 1 << 0,
+    STORAGE_GYRO = 1 << 1,
+    STORAGE_FOC_L = 1 << 2,
+    STORAGE_FOC_R = 1 << 3,
+    STORAGE_PID = 1 << 4,
+    STORAGE_TORQUE_LIMIT = 1 << 5,
+    STORAGE_PITCH_ZERO = 1 << 6,
+    STORAGE_WS_PASSWORD = 1 << 7,
+    STORAGE_ROBOT_NAME = 1 << 8,
+    STORAGE_WIFI = 1 << 9,
+};
+
+// blob 负载。只允许在末尾追加字段并提升 STORAGE_VERSION：
+// 旧版本 blob 按其长度拷贝前缀，新字段保持未设置。
+// 字段全部在此定义（不嵌入其他模块的结构体），布局由下方断言锁定，改动即编译失败
+struct storage_settings
+{
+    uint32_t present;
+    float dzL, dzR;
+    float gx, gy, gz;
+    float foc_zero[2];
+    int8_t foc_dir[2]; // 编码器方向（1 / -1）
+    uint8_t reserved[2];
+    float pid_ang_p, pid_ang_i, pid_ang_d;
+    float pid_spd_p, pid_spd_i, pid_spd_d;
+    float pid_yaw_p, pid_yaw_i, pid_yaw_d;
+    float torque_limit;
+    float pitch_zero;
+    char ws_password[STORAGE_PWD_MAX + 1];
+    char robot_name[STORAGE_NAME_MAX + 1];
+    char wifi_ssid[STORAGE_SSID_MAX + 1];
+    char wifi_pass[STORAGE_WIFI_PASS_MAX + 1];
+};
+
+#define STORAGE_VERSION 1
+
+// STORAGE_VERSION 1 的布局；断言失败说明布局变了，须提升版本并更新这里
+static_assert(offsetof(storage_settings, dzL) == 4, "storage_settings layout changed");
+static_assert(offsetof(storage_settings, gx) == 12, "storage_settings layout changed");
+static_assert(offsetof(storage_settings, foc_zero) == 24, "storage_settings layout changed");
+static_assert(offsetof(storage_settings, foc_dir) == 32, "storage_settings layout changed");
+static_assert(offsetof(storage_settings, pid_ang_p) == 36, "storage_settings layout changed");
+static_assert(offsetof(storage_settings, torque_limit) == 72, "storage_settings layout changed");
+static_assert(offsetof(storage_settings, pitch_zero) == 76, "storage_settings layout changed");
+static_assert(offsetof(storage_settings, ws_password) == 80, "storage_settings layout changed");
+static_assert(offsetof(storage_settings, wifi_pass) == 211, "storage_settings layout changed");
+static_assert(sizeof(storage_settings) == 276, "storage_settings layout changed");
 
-// 简单的 NVS 存取封装
 bool storage_load_calib(float &dzL, float &dzR);
 void storage_save_calib(float dzL, float dzR);
 
 bool storage_load_gyro_bias(float &gx, float &gy, float &gz);
 void storage_save_gyro_bias(float gx, float gy, float gz);
 
-// 通用键值存取（字符串 / 浮点），便于网络配置、命名等功能复用
-bool storage_load_string(const char *key, String &out);
-void storage_save_string(const char *key, const String &value);
+// 电机对齐结果：motor 为 0/1，direction 为编码器方向（1 / -1）
+bool storage_load_foc_align(uint8_t motor, float &zero_angle, int8_t &direction);
+void storage_save_foc_align(uint8_t motor, float zero_angle, int8_t direction);
+void storage_clear_foc_align();
+
+bool storage_load_pid(cmd_pid &out);
+void storage_save_pid(const cmd_pid &pid);
+bool storage_load_torque_limit(float &out);
+void storage_save_torque_limit(float value);
+bool storage_load_pitch_zero(float &out);
+void storage_save_pitch_zero(float value);
+
+#ifdef ARDUINO
+enum class StorageText : uint8_t
+{
+    WsPassword,
+    RobotName,
+};
+bool storage_load_text(StorageText which, String &out);
+void storage_save_text(StorageText which, const String &value);
+// SSID 与密码同一次提交
+bool storage_load_wifi(String &ssid, String &pass);
+void storage_save_wifi(const String &ssid, const String &pass);
+#endif
+
+// 读入配置（含旧版逐键存储的迁移）并启动低优先级持久化任务（核心 1），须在其他模块读取配置前调用
+void storage_start();
+// 立即同步落盘，重启前调用
+void storage_flush();
+
+// 启动时配置的来源
+enum class StorageOrigin : uint8_t
+{
+    Empty,   // 无任何存档，全部默认
+    Blob,    // 读到有效 blob
+    Legacy,  // 由旧版逐键存储迁移
+    Corrupt, // blob 校验失败，已回退默认
+};
+const char *storage_origin_name(StorageOrigin origin);
 
-bool storage_load_float(const char *key, float &out);
-void storage_save_float(const char *key, float value);
+struct storage_stats
+{
+    uint32_t commits;        // 落盘次数
+    uint32_t bytes_written;
+    uint32_t failures;       // 写入失败次数（失败后保留待写，下次更新时重试）
+    bool pending;            // 有尚未落盘的修改
+    StorageOrigin origin;
+    uint32_t load_us;        // 启动读入耗时
+    uint32_t last_commit_us; // 最近一次落盘耗时
+    uint32_t max_commit_us;
+};
+storage_stats storage_get_stats();
@@ -1,8 +1,12 @@
 #pragma once
 
+#include <stddef.h>
+#include <stdint.h>
 #include "my_config.h"
 
 float my_lim(float value, float min, float max);
 float my_lim(float value, float lim);
 float my_db(float value, float deadband);
+// CRC-32（IEEE 802.3），crc 传入上一段的结果可分段计算
+uint32_t my_crc32(const void *data, size_t len, uint32_t crc = 0);
 static inline void rtrim_inplace(char *s);
\ No newline at end of file
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "my_config.h"
+
+// 热重启：控制任务每 WARM_SAVE_MS 把已收敛的估计量（姿态四元数、陀螺零偏、死区、pitch 零点）
+// 连同 CRC 写入复位后仍保留的内存。软件复位 / 看门狗 / 异常复位后由 my_motion_init 取回，
+// 跳过零偏采样与姿态、零点的重新收敛；冷启动、校验失败、取值越界或连续热启动过多时走正常流程
+
+// 启动时调用一次：保留区有效则写回 robot 与 AHRS 并返回 true
+bool warm_restore(robot_state &robot);
+// 本次是否为热启动
+bool warm_booted();
+
+// 控制任务每周期调用，内部按 WARM_SAVE_MS 降频
+void warm_save(const robot_state &robot);
+
+// MPU 驱动零偏（deg/s）：冷启动采样后登记；热启动时取回上次的值，仅第一次调用返回 true，
+// 之后的 IMU 重启照常重新采样
+void warm_set_imu_offsets(float gx, float gy, float gz);
+bool warm_take_imu_offsets(float &gx, float &gy, float &gz);
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <stdint.h>
+
+// 遥测通道登记表：schema 由此生成，订阅按名称选取
+// col >= 0 的通道取自全速率采集列（可按周期聚合），否则在发送时读取当前值
+struct telem_channel
+{
+    const char *name;
+    const char *label;
+    int8_t col;            // ChartChannel，-1 表示发送时读取
+    float (*xform)(float); // 采集值换算（单调），可为空
+    float (*read)();       // col < 0 时使用
+};
+
+uint8_t net_channel_count();
+const telem_channel &net_channel(uint8_t idx);
+// 按名称查找，找不到返回 -1
+int net_channel_find(const char *name);
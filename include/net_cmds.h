@@ -0,0 +1,97 @@
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+// WebSocket 指令表：X(类型字符串, 处理函数, 标志)，顺序即 NetCmdId
+// 分发按类型字符串的 FNV-1a 哈希做 switch，新增指令若与已有指令哈希冲突会在编译期报重复 case
+// 本头文件不依赖 Arduino，主机基准测试直接复用同一张表
+
+// FNV-1a 字符串哈希，可在编译期求值（用作 switch 的 case）
+constexpr uint32_t net_cmd_hash(const char *s, uint32_t h = 2166136261u)
+{
+    return *s ? net_cmd_hash(s + 1, (h ^ static_cast<uint8_t>(*s)) * 16777619u) : h;
+}
+
+enum : uint8_t
+{
+    NET_CMD_NO_AUTH = 1 << 0, // 设置了密码时也允许未认证客户端调用
+};
+
+#define NET_COMMANDS(X) \
+    X("auth", on_auth, NET_CMD_NO_AUTH) \
+    X("robot_run", on_robot_run, 0) \
+    X("fall_check", on_fall_check, 0) \
+    X("suspension_stop", on_suspension_stop, 0) \
+    X("estop", on_estop, 0) \
+    X("system_restart", on_system_restart, 0) \
+    X("restart_imu", on_restart_imu, 0) \
+    X("restart_motor", on_restart_motor, 0) \
+    X("foc_realign", on_foc_realign, 0) \
+    X("calib_imu", on_calib_imu, 0) \
+    X("calib_deadzone", on_calib_deadzone, 0) \
+    X("restart_wifi", on_restart_wifi, 0) \
+    X("telem_format", on_telem_format, 0) \
+    X("subscribe", on_subscribe, 0) \
+    X("telem_hz", on_telem_hz, 0) \
+    X("ext_hz", on_ext_hz, 0) \
+    X("attitude_send", on_attitude_send, 0) \
+    X("charts_send", on_charts_send, 0) \
+    X("get_pid", on_get_pid, 0) \
+    X("set_pid", on_set_pid, 0) \
+    X("get_pitch_zero", on_get_pitch_zero, 0) \
+    X("pitch_zero_set", on_pitch_zero_set, 0) \
+    X("get_deadzone", on_get_deadzone, 0) \
+    X("set_torque_limit", on_set_torque_limit, 0) \
+    X("get_torque_limit", on_get_torque_limit, 0) \
+    X("joy", on_joy, 0) \
+    X("test_mode", on_test_mode, 0) \
+    X("set_motor_mode", on_set_motor_mode, 0) \
+    X("set_motor", on_set_motor, 0) \
+    X("set_servo", on_set_servo, 0) \
+    X("set_leds", on_set_leds, 0) \
+    X("set_rgb", on_set_rgb, 0) \
+    X("screen_data_v2", on_screen_data_v2, 0) \
+    X("get_wifi_config", on_get_wifi_config, 0) \
+    X("set_wifi_config", on_set_wifi_config, 0) \
+    X("get_sys_info", on_get_sys_info, 0) \
+    X("get_timing", on_get_timing, 0) \
+    X("timing_reset", on_timing_reset, 0) \
+    X("get_boot", on_get_boot, 0) \
+    X("set_name", on_set_name, 0) \
+    X("set_password", on_set_password, 0)
+
+#define NET_CMD_ID(type, fn, flags) NET_CMD_##fn,
+enum NetCmdId : uint8_t
+{
+    NET_COMMANDS(NET_CMD_ID) NET_CMD_COUNT
+};
+#undef NET_CMD_ID
+
+struct net_cmd_info
+{
+    const char *type;
+    uint8_t flags;
+};
+
+#define NET_CMD_INFO(type, fn, flags) {type, flags},
+inline constexpr net_cmd_info net_cmd_infos[NET_CMD_COUNT] = {NET_COMMANDS(NET_CMD_INFO)};
+#undef NET_CMD_INFO
+
+// 类型字符串 → NetCmdId，未识别返回 -1；哈希命中后再比较一次字符串
+inline int net_cmd_find(const char *type)
+{
+    int id = -1;
+    switch (net_cmd_hash(type))
+    {
+#define NET_CMD_CASE(type, fn, flags) \
+    case net_cmd_hash(type):          \
+        id = NET_CMD_##fn;            \
+        break;
+        NET_COMMANDS(NET_CMD_CASE)
+#undef NET_CMD_CASE
+    default:
+        return -1;
+    }
+    return strcmp(net_cmd_infos[id].type, type) == 0 ? id : -1;
+}
@@ -2,13 +2,9 @@
 
 #include <ArduinoJson.h>
 #include <ESPAsyncWebServer.h>
+#include "net_cmds.h"
 
-bool handle_auth_cmd(AsyncWebSocketClient *client, const char *type, JsonDocument &doc);
-bool handle_control_cmd(const char *type, JsonDocument &doc);
-bool handle_freq_cmd(const char *type, JsonDocument &doc);
-bool handle_pid_cmd(AsyncWebSocketClient *client, const char *type, JsonDocument &doc);
-bool handle_motion_cmd(const char *type, JsonDocument &doc);
-bool handle_rgb_cmd(const char *type, JsonDocument &doc);
-bool handle_screen_cmd(const char *type, JsonDocument &doc);
-bool handle_wifi_cmd(AsyncWebSocketClient *client, const char *type, JsonDocument &doc);
-bool handle_info_cmd(AsyncWebSocketClient *client, const char *type, JsonDocument &doc);
+typedef void (*net_cmd_handler)(AsyncWebSocketClient *client, JsonDocument &doc);
+
+// 执行 net_cmd_find 查到的指令；认证检查由调用方按 net_cmd_infos[id].flags 完成
+void net_cmd_invoke(int id, AsyncWebSocketClient *client, JsonDocument &doc);
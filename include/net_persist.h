@@ -1,6 +1,7 @@
 #pragma once
 
 #include <Arduino.h>
+#include "my_cmd.h"
 
 struct NetPersist
 {
@@ -9,9 +10,14 @@ struct NetPersist
     String wifi_ssid;
     String wifi_pass;
     float pitch_zero;
+    float torque_limit; // 尚无快照时的回退值，随成功入队的 TorqueLimit 更新
+    // 网络侧 PID 副本：部分字段的 set_pid 与它合并，不读控制任务所有的 robot.*_pid；
+    // my_net_init 在控制任务启动前从 robot 取初值，之后只随成功入队的 SetPid 更新
+    cmd_pid pid;
 };
 
-void net_persist_load(NetPersist &out, float pitch_zero_default);
+// pitch_zero 为当前生效的零点（robot.pitch_zero），存档读取与热启动恢复均已由 my_motion_init 完成
+void net_persist_load(NetPersist &out, float pitch_zero);
 void net_persist_save_password(const String &pwd);
 void net_persist_save_name(const String &name);
 void net_persist_save_wifi(const String &ssid, const String &pass);
@@ -7,6 +7,8 @@
 
 #include "net_persist.h"
 #include "my_config.h"
+#include "my_cmd.h"
+#include "net_stream.h"
 
 // 全局网络状态
 extern AsyncWebServer server;
@@ -21,11 +23,44 @@ extern const char *NET_AP_SSID;
 extern const char *NET_AP_PASS;
 extern const char *NET_FW_VERSION;
 
+// 遥测编码：JSON 为默认，二进制格式见 net_wire.h
+enum class WireFormat : uint8_t
+{
+    Json,
+    Binary,
+};
+
+// 客户端登记（最多 NET_MAX_CLIENTS 个），遥测按各自协商的格式分发
+void net_client_add(uint32_t id);
+void net_client_remove(uint32_t id);
+bool net_client_set_format(uint32_t id, WireFormat fmt);
+// 按槽位访问（0 ~ NET_MAX_CLIENTS-1）：id 不在线返回 -1；空位返回 id 0
+int net_client_slot(uint32_t id);
+uint32_t net_client_at(uint8_t slot, WireFormat &fmt, bool &subscribed);
+// 认证状态随客户端登记，断开即清除
+void net_client_set_authed(uint32_t id);
+bool net_client_authed(uint32_t id);
+// 订阅的客户端改由 net_stream 推送，固定遥测跳过它
+void net_client_set_subscribed(uint8_t slot, bool on);
+
 // 基础工具
-float battery_pct();
+float battery_pct(float v);
 String current_ip();
 bool decode_base64(const String &in, std::vector<uint8_t> &out);
 
+// 出站缓冲：消息只编码一次写入引用计数缓冲，多个客户端队列共享同一份，不再逐客户端拷贝 String
+// 返回的缓冲已加锁，发送完调用 net_release_buffer；分配失败返回 nullptr（本条消息丢弃）
+AsyncWebSocketMessageBuffer *net_json_buffer(const JsonDocument &doc);
+AsyncWebSocketMessageBuffer *net_bin_buffer(size_t len);
+void net_send_buffer(uint32_t id, AsyncWebSocketMessageBuffer *buf, bool binary);
+// 周期帧（遥测/曲线/订阅）专用：客户端队列积压达 NET_CLIENT_QUEUE_SOFT 时丢弃本帧并计数，
+// 持续积压超过 NET_CLIENT_STALL_MS 的客户端被断开；返回是否已入队
+bool net_send_stream(uint32_t id, AsyncWebSocketMessageBuffer *buf, bool binary);
+void net_release_buffer(AsyncWebSocketMessageBuffer *buf);
+
+// 控制周期（us）：取自快照，尚未发布时为 CONTROL_PERIOD_US
+uint32_t net_period_us();
+
 // 下行消息辅助
 void send_json(AsyncWebSocketClient *client, const JsonDocument &doc);
 void send_state(AsyncWebSocketClient *client = nullptr);
@@ -34,10 +69,16 @@ void send_sys_info(AsyncWebSocketClient *client);
 void send_wifi_config(AsyncWebSocketClient *client);
 void send_wifi_save_status(AsyncWebSocketClient *client, const char *status, const char *message = "");
 void send_pid(AsyncWebSocketClient *client);
+void send_pid(AsyncWebSocketClient *client, const cmd_pid &v); // 回显刚入队、尚未生效的参数
 void send_pitch_zero(AsyncWebSocketClient *client);
+void send_pitch_zero(AsyncWebSocketClient *client, float value);
 void send_torque_limit(AsyncWebSocketClient *client);
 void send_deadzone(AsyncWebSocketClient *client);
 void send_schema(AsyncWebSocketClient *client);
+void send_timing(AsyncWebSocketClient *client);
+void send_boot(AsyncWebSocketClient *client);
+void send_subscription(AsyncWebSocketClient *client, const sub_request &req, uint16_t decim);
+void send_telem_format(AsyncWebSocketClient *client, WireFormat fmt);
 void broadcast_telemetry();
 void broadcast_extended();
 
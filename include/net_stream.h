@@ -0,0 +1,27 @@
+#pragma once
+
+#include <stdint.h>
+#include "my_config.h"
+
+// 全速率数据流：独立任务每 TELEM_STREAM_MS 取空采集环，
+// 分发给曲线批量帧（未订阅的二进制客户端）与各客户端的按通道订阅
+
+enum class SubAgg : uint8_t
+{
+    Mean,   // 每通道只发均值
+    MinMax, // 均值、最小、最大
+};
+
+struct sub_request
+{
+    uint8_t n; // 通道数，0 表示取消订阅
+    uint8_t ch[TELEM_SUB_MAX_CH]; // net_channel 下标
+    float rate_hz;
+    SubAgg agg;
+};
+
+// WS 回调侧：设置订阅，返回生效的抽取倍数（按控制周期计），失败返回 0
+uint16_t net_stream_subscribe(uint32_t client_id, const sub_request &req);
+void net_stream_unsubscribe(uint32_t client_id);
+
+void net_stream_start();
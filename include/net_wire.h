@@ -0,0 +1,111 @@
+#pragma once
+
+#include <stdint.h>
+
+// 二进制遥测帧：小端紧凑结构，客户端发送 {"type":"telem_format","format":"bin"} 后
+// telemetry/extended 以 WS 二进制帧下发，未协商的客户端仍收 JSON
+// 客户端上行的二进制帧（目前只有屏幕帧）复用同一头部，服务端按 kind 分派
+// 结构只允许在末尾追加字段；改动已有字段须提升 NET_WIRE_VERSION
+
+#define NET_WIRE_MAGIC 0xB7
+#define NET_WIRE_VERSION 1
+
+enum class WireKind : uint8_t
+{
+    Telemetry = 1,
+    Extended = 2,
+    ChartBatch = 3,
+    Subscription = 4,
+    Screen = 5, // 上行
+};
+
+// 状态位（wire_telemetry::bits）
+enum : uint8_t
+{
+    WIRE_BIT_FALLEN = 1 << 0,
+    WIRE_BIT_WEL_UP = 1 << 1,
+    WIRE_BIT_DRV_FAULT = 1 << 2,
+    WIRE_BIT_LOWBAT = 1 << 3,
+};
+
+struct __attribute__((packed)) wire_header
+{
+    uint8_t magic;   // NET_WIRE_MAGIC
+    uint8_t version; // NET_WIRE_VERSION
+    uint8_t kind;    // WireKind
+    uint8_t size;    // 本结构字节数（不含批量帧后随的列数据），旧客户端据此跳过新增字段
+    uint32_t seq;    // robot_frame::seq
+    uint32_t t_ms;   // robot_frame::t_ms
+};
+
+struct __attribute__((packed)) wire_telemetry
+{
+    wire_header h;
+    uint8_t state; // MotionState
+    uint8_t bits;
+    uint16_t reserved;
+    float pitch, roll, yaw;
+    float battery; // %
+    float voltage;
+    float speed_l, speed_r;
+    float torque_l, torque_r;
+    float dzL, dzR;
+};
+
+struct __attribute__((packed)) wire_extended
+{
+    wire_header h;
+    float ang_tar;
+    float pitch;
+    float spd_tar;
+    float spd_now;
+    float torque_l, torque_r;
+    float speed_l, speed_r;
+    float gyro_y;
+    float acc_y;
+    float battery;
+    float loop_us;
+    float loop_p99;
+    uint32_t overruns;
+};
+
+// 全速率曲线批量帧：头部后紧跟 channels 列，每列 count 个 float，列顺序见 my_chart.h
+// h.seq/h.t_ms 为首样本，第 i 个样本序号为 h.seq + i
+struct __attribute__((packed)) wire_chart_batch
+{
+    wire_header h;
+    uint32_t period_us; // 样本间隔（控制周期）
+    uint16_t count;
+    uint8_t channels;
+    uint8_t reserved;
+    uint32_t overflows; // 累计因缓冲满丢弃的样本数
+};
+
+// 订阅帧：头部后按订阅通道顺序，每通道 1 个（Mean）或 3 个（MinMax：均值、最小、最大）float
+// h.seq/h.t_ms 为本聚合窗口的首个样本
+struct __attribute__((packed)) wire_subscription
+{
+    wire_header h;
+    uint16_t count; // 窗口内聚合的控制周期数
+    uint8_t channels;
+    uint8_t agg;    // SubAgg
+};
+
+// 上行屏幕帧：头部后紧跟 pages*cols 字节 SSD1306 页格式数据（每字节纵向 8 像素、LSB 在上），
+// 按页逐行排列，直接拷入显存；整屏为 page=0,pages=8,col=0,cols=128，共 1024 字节
+// h.seq/h.t_ms 由客户端自定，服务端不使用
+struct __attribute__((packed)) wire_screen
+{
+    wire_header h;
+    uint8_t page;
+    uint8_t pages;
+    uint8_t col;
+    uint8_t cols;
+};
+
+static_assert(sizeof(wire_header) == 12, "wire_header layout");
+static_assert(sizeof(wire_telemetry) == 60, "wire_telemetry layout");
+static_assert(sizeof(wire_extended) == 68, "wire_extended layout");
+static_assert(sizeof(wire_chart_batch) == 24, "wire_chart_batch layout");
+static_assert(sizeof(wire_subscription) == 16, "wire_subscription layout");
+static_assert(sizeof(wire_screen) == 16, "wire_screen layout");
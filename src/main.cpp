@@ -1,59 +1,132 @@
 #include <Arduino.h>
 #include "my_i2c.h"
 #include "my_mpu6050.h"
+#include "my_ahrs.h"
+#include "my_acq.h"
 #include "my_bat.h"
 #include "my_motion.h"
 #include "my_foc.h"
 #include "my_screen.h"
 #include "my_net.h"
+#include "my_prof.h"
+#include "my_sched.h"
+#include "my_cmd.h"
+#include "my_control.h"
+#include "my_motion_state.h"
+#include "my_boot.h"
+#include "my_storage.h"
 
 // FreeRTOS 任务句柄
 static TaskHandle_t control_task_handle = nullptr;
 static TaskHandle_t screen_task_handle = nullptr;
 
-// 控制周期：从 robot.dt_ms 读取（单位 ms）
-static inline TickType_t control_period_ticks()
-{
-    return pdMS_TO_TICKS(robot.dt_ms);
-}
-
 // 屏幕刷新周期：使用 SCREEN_REFRESH_TIME（单位 ms）
 static inline TickType_t screen_period_ticks()
 {
     return pdMS_TO_TICKS(SCREEN_REFRESH_TIME);
 }
 
+// 网页端请求的硬件重启：阻塞数秒，在控制任务内串行执行，期间输出清零
+static void run_hw_requests(uint8_t req)
+{
+    hal_motor_output(HalMotorLoop::Torque, 0.0f, 0.0f);
+    if (req & CMD_HW_RESTART_IMU)
+    {
+        my_mpu6050_init();
+        // 复位会清掉中断使能，数据就绪模式下重新打开
+        if (my_acq_drdy_active())
+            mpu6050_enable_data_ready(static_cast<uint16_t>(1000000UL / robot.dt_us));
+    }
+    if (req & CMD_HW_REALIGN_MOTOR)
+        my_motor_forget_alignment();
+    if (req & (CMD_HW_RESTART_MOTOR | CMD_HW_REALIGN_MOTOR))
+        my_motor_init();
+    control_reset(robot);
+}
+
 // 控制任务：高优先级，绑定核心 0
 void control_task(void *)
 {
-    // 初始化时间基准
-    TickType_t last_wake = xTaskGetTickCount();
+    // 微秒级周期定时器（数据就绪模式下由 IMU 中断计拍）
+    my_sched_start(xTaskGetCurrentTaskHandle(), robot.dt_us);
+    robot.dt_us = my_sched_period_us();
+    uint32_t prev_start = 0;
+    bool resync = false;
+    bool balanced = false;
+    boot_mark(BootStage::Control);
 
     for (;;)
     {
-        // 传感器更新
-        my_mpu6050_update();
+        uint32_t ticks = my_sched_wait();
+        if (ticks == 0)
+        {
+            // 数据就绪中断丢失，退回定时器节拍
+            my_acq_drdy_stop();
+            continue;
+        }
+        if (resync)
+        {
+            // 硬件重启期间跳过的节拍不计入 dt
+            ticks = 1;
+            prev_start = 0;
+            resync = false;
+        }
+        robot.dt = ticks * robot.dt_us * 1e-6f;
+
+        const uint32_t t0 = prof_now();
+        if (prev_start != 0)
+            prof_add(ProfStage::Period, t0 - prev_start);
+        prev_start = t0;
+
+        // 传感器快照（两路总线已在上一周期末并行预取，或随数据就绪中断同步读取）
+        hal_sense_snapshot snap;
+        hal_sense_read(snap);
+        ahrs_update(robot, snap.imu, robot.dt);
+        const uint32_t t1 = prof_now();
         my_bat_update();
+        const uint32_t t2 = prof_now();
 
         // 运动学与状态机
-        my_motion_update();
+        my_motion_update(snap);
+        const uint32_t t3 = prof_now();
 
-        // 力矩输出到电机
+        // 力矩目标交给换相任务
         my_motor_update();
+        const uint32_t t4 = prof_now();
+
+        prof_add(ProfStage::Imu, t1 - t0);
+        prof_add(ProfStage::Bat, t2 - t1);
+        prof_add(ProfStage::Motion, t3 - t2);
+        prof_add(ProfStage::Motor, t4 - t3);
+        prof_cycle_end(t4 - t0, robot.dt_us);
+
+        if (!balanced && robot.state == MotionState::Normal)
+        {
+            boot_mark(BootStage::Balance);
+            balanced = true;
+        }
 
-        // 周期调度
-        vTaskDelayUntil(&last_wake, control_period_ticks());
+        const uint8_t hw = cmd_take_hw_requests();
+        if (hw)
+        {
+            run_hw_requests(hw);
+            resync = true;
+        }
+
+        // 预约下一周期的快照，赶在下一拍前读完
+        my_acq_schedule(my_sched_next_us());
     }
 }
 
-// 屏幕任务：中优先级，绑定核心 1
+// 屏幕任务：中优先级，绑定核心 1；先播开机动画（与传感器、电机初始化并行），外部帧到达时被提前唤醒
 void screen_task(void *)
 {
-    TickType_t last_wake = xTaskGetTickCount();
+    my_screen_play_boot();
+    my_screen_attach(xTaskGetCurrentTaskHandle());
     for (;;)
     {
         my_screen_update();
-        vTaskDelayUntil(&last_wake, screen_period_ticks());
+        ulTaskNotifyTake(pdTRUE, screen_period_ticks());
     }
 }
 
@@ -62,20 +135,32 @@ void setup()
     Serial.begin(115200);
     delay(100);
 
-    // 硬件初始化
+    storage_start();
     my_i2c_init();
-    my_mpu6050_init();
     my_bat_init();
-    my_motor_init();
     my_motion_init();
+
+    // 开机动画与 WiFi/AP 先起来，与下面的传感器、电机初始化并行
     my_screen_init();
+    xTaskCreatePinnedToCore(screen_task, "screen", 4096, nullptr, 3, &screen_task_handle, 1);
+    boot_begin(BootStage::Net);
     my_net_init();
+    boot_end(BootStage::Net);
+
+    // 陀螺零偏采样要求车身静止，须在电机对齐（会抖动车轮）之前完成
+    boot_begin(BootStage::Imu);
+    my_mpu6050_init();
+    boot_end(BootStage::Imu);
+
+    // 左右电机在两个核上并行对齐
+    my_motor_init();
+    my_foc_start_task();
+    my_acq_start();
+    if (MPU_INT_PIN >= 0 && my_acq_use_drdy(MPU_INT_PIN, robot.dt_us))
+        Serial.println("控制任务同步到 IMU 数据就绪中断");
 
     // 创建控制任务（核心0，最高优先级）
     xTaskCreatePinnedToCore(control_task, "control", 8192, nullptr, configMAX_PRIORITIES - 1, &control_task_handle, 0);
-
-    // 创建屏幕任务（核心1，中等优先级）
-    xTaskCreatePinnedToCore(screen_task, "screen", 4096, nullptr, 3, &screen_task_handle, 1);
 }
 
 void loop()
@@ -0,0 +1,343 @@
+#include "Arduino.h"
+#include <algorithm>
+#include <atomic>
+#include <esp_timer.h>
+#include "my_acq.h"
+#include "my_config.h"
+#include "my_foc.h"
+#include "my_i2c.h"
+#include "my_mpu6050.h"
+#include "my_sched.h"
+
+static_assert(ACQ_LEAD_US >= ACQ_READ_US, "ACQ_LEAD_US must cover one frame read");
+
+namespace
+{
+enum Bus : uint8_t
+{
+    Bus0, // Wire0：MPU6050 + 左 AS5600
+    Bus1, // Wire1：右 AS5600（与屏幕共用）
+    BusCount
+};
+
+// 单路总线本帧读到的数据，仅由对应采集任务写
+struct bus_part
+{
+    hal_imu_sample imu; // 仅 Bus0
+    uint32_t imu_us;
+    float w;            // 本路编码器角速度（换相任务未运行时）
+    uint32_t wheel_us;
+    bool alive;
+};
+
+TaskHandle_t bus_task[BusCount] = {nullptr, nullptr};
+bus_part part[BusCount];
+std::atomic<uint8_t> in_flight{0}; // 本帧尚未读完的总线数
+SemaphoreHandle_t frame_ready = nullptr;
+esp_timer_handle_t acq_timer = nullptr;
+esp_timer_handle_t wait_timer = nullptr; // my_acq_take 的等待时限
+volatile bool acq_running = false;
+
+// 数据就绪模式：预约只置位 armed，由 MPU6050 INT 中断放行两路采集
+volatile bool drdy_active = false;
+int drdy_pin = -1;
+std::atomic<bool> armed{false};
+volatile bool frame_from_drdy = false;
+volatile uint32_t drdy_us = 0; // 中断时刻即样本就绪时刻，比读取起点更准
+
+// 以下仅控制任务访问（job_check_alive 在通知采集任务前写入）
+bool scheduled = false; // 已预约且尚未取走
+bool job_check_alive = false;
+uint32_t last_alive_ms = 0;
+bool last_alive = true;
+hal_sense_snapshot last_snap{};
+uint32_t frames = 0;
+uint32_t misses = 0;
+uint32_t miss_streak = 0;
+uint32_t lead_us = ACQ_LEAD_US; // 按控制周期缩放后的预取提前量与等待上限
+uint32_t wait_us = ACQ_WAIT_US;
+
+bool ping(TwoWire &w, uint8_t addr)
+{
+    w.beginTransmission(addr);
+    return w.endTransmission() == 0;
+}
+
+// 按控制周期缩放流水线：提前量不超过一个周期（即最早在上一周期末立刻开始读取）；
+// 定时器模式下等待不超过半个周期，另一半留给控制计算，没读完的帧由下一周期直接取走。
+// 数据就绪模式的读取在节拍时刻才开始，等待须覆盖整次读取，不缩放
+void fit_period()
+{
+    const uint32_t period = my_sched_period_us();
+    lead_us = std::min<uint32_t>(ACQ_LEAD_US, period);
+    wait_us = drdy_active ? ACQ_WAIT_US : std::min<uint32_t>(ACQ_WAIT_US, period / 2);
+}
+
+bool alive_check_due()
+{
+    const uint32_t now = millis();
+    if (now - last_alive_ms < I2C_FAULT_CHECK_MS)
+        return false;
+    last_alive_ms = now;
+    return true;
+}
+
+// 换相任务运行时编码器由其独占，这里只读 IMU 与应答
+void read_bus0(bus_part &p, bool check_alive)
+{
+    hal_imu_read(p.imu, p.imu_us);
+    if (!my_foc_task_running())
+    {
+        sensor_1.update();
+        p.w = sensor_1.getVelocity();
+        p.wheel_us = micros();
+    }
+    if (check_alive)
+        p.alive = ping(Wire0, ADDR_MPU6050) && ping(Wire0, ADDR_AS5600);
+}
+
+void read_bus1(bus_part &p, bool check_alive)
+{
+    const bool read_wheel = !my_foc_task_running();
+    if (!read_wheel && !check_alive)
+        return;
+    // 无换相任务时右编码器随控制周期读取，是 Wire1 上的周期性事务
+    if (read_wheel)
+        i2c1_hi_begin_periodic(I2cDev::As5600R);
+    else
+        i2c1_hi_begin(I2cDev::As5600R);
+    if (read_wheel)
+    {
+        sensor_2.update();
+        p.w = sensor_2.getVelocity();
+        p.wheel_us = micros();
+    }
+    if (check_alive)
+        p.alive = ping(Wire1, ADDR_AS5600);
+    i2c1_hi_end();
+}
+
+// 采集任务：被定时器唤醒后读本路总线，最后完成的一路通知控制任务
+void bus_task_fn(void *arg)
+{
+    const Bus bus = static_cast<Bus>(reinterpret_cast<uintptr_t>(arg));
+    for (;;)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        if (bus == Bus0)
+            read_bus0(part[Bus0], job_check_alive);
+        else
+            read_bus1(part[Bus1], job_check_alive);
+        if (in_flight.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            xSemaphoreGive(frame_ready);
+    }
+}
+
+// 等待到时：唤醒控制任务，由它根据 in_flight 判定超时
+void wait_timer_cb(void *)
+{
+    xSemaphoreGive(frame_ready);
+}
+
+// 两路同时放行，各自阻塞在自己的 I2C 控制器上
+void acq_timer_cb(void *)
+{
+    for (TaskHandle_t t : bus_task)
+        xTaskNotifyGive(t);
+}
+
+// 新样本就绪：每个中断都给控制任务计一拍；已预约则同时放行采集，
+// 否则（控制周期尚未结束）这一帧不读
+void IRAM_ATTR drdy_isr()
+{
+    BaseType_t woken = pdFALSE;
+    if (armed.exchange(false))
+    {
+        drdy_us = micros();
+        frame_from_drdy = true;
+        for (TaskHandle_t t : bus_task)
+            vTaskNotifyGiveFromISR(t, &woken);
+    }
+    my_sched_tick_from_isr(&woken);
+    portYIELD_FROM_ISR(woken);
+}
+
+// 未预约时在控制任务内顺序读取
+void read_sync(hal_sense_snapshot &out)
+{
+    hal_imu_read(out.imu, out.imu_us);
+    hal_wheel_read(out.wL, out.wR);
+    out.wheel_us = micros();
+    if (alive_check_due())
+        last_alive = hal_sensors_alive();
+    out.alive = last_alive;
+}
+
+void assemble(hal_sense_snapshot &out)
+{
+    out.imu = part[Bus0].imu;
+    out.imu_us = frame_from_drdy ? drdy_us : part[Bus0].imu_us;
+    if (my_foc_task_running())
+    {
+        // 对换相任务发布的角度做差分，不占用总线
+        hal_wheel_read(out.wL, out.wR);
+        out.wheel_us = micros();
+    }
+    else
+    {
+        out.wL = part[Bus0].w;
+        out.wR = part[Bus1].w;
+        out.wheel_us = part[Bus0].wheel_us;
+    }
+    if (job_check_alive)
+        last_alive = part[Bus0].alive && part[Bus1].alive;
+    out.alive = last_alive;
+}
+} // namespace
+
+void my_acq_start()
+{
+    if (acq_running)
+        return;
+    frame_ready = xSemaphoreCreateBinary();
+    xTaskCreatePinnedToCore(bus_task_fn, "acq0", ACQ_TASK_STACK, reinterpret_cast<void *>(Bus0),
+                            configMAX_PRIORITIES - 2, &bus_task[Bus0], 0);
+    xTaskCreatePinnedToCore(bus_task_fn, "acq1", ACQ_TASK_STACK, reinterpret_cast<void *>(Bus1),
+                            configMAX_PRIORITIES - 2, &bus_task[Bus1], 1);
+
+    const esp_timer_create_args_t args = {
+        .callback = acq_timer_cb,
+        .arg = nullptr,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "acq",
+        .skip_unhandled_events = false,
+    };
+    esp_timer_create(&args, &acq_timer);
+    const esp_timer_create_args_t wait_args = {
+        .callback = wait_timer_cb,
+        .arg = nullptr,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "acq_wait",
+        .skip_unhandled_events = true,
+    };
+    esp_timer_create(&wait_args, &wait_timer);
+    acq_running = true;
+}
+
+bool my_acq_running()
+{
+    return acq_running;
+}
+
+bool my_acq_use_drdy(int pin, uint32_t period_us)
+{
+    if (!acq_running || pin < 0 || period_us == 0)
+        return false;
+    if (!mpu6050_enable_data_ready(static_cast<uint16_t>(1000000UL / period_us)))
+        return false;
+    drdy_pin = pin;
+    pinMode(pin, INPUT);
+    attachInterrupt(digitalPinToInterrupt(pin), drdy_isr, RISING);
+    drdy_active = true;
+    my_sched_use_external(true);
+    return true;
+}
+
+void my_acq_drdy_stop()
+{
+    if (!drdy_active)
+        return;
+    detachInterrupt(digitalPinToInterrupt(drdy_pin));
+    drdy_active = false;
+    my_sched_use_external(false);
+    // 已预约但未放行的帧立即放行
+    if (armed.exchange(false))
+        acq_timer_cb(nullptr);
+    Serial.println("IMU 数据就绪中断超时，退回定时器调度");
+}
+
+bool my_acq_drdy_active()
+{
+    return drdy_active;
+}
+
+void my_acq_schedule(uint32_t due_us)
+{
+    // 上一帧尚未取走（等待超时）时不叠加新帧
+    if (!acq_running || scheduled)
+        return;
+    fit_period();
+    job_check_alive = alive_check_due();
+    frame_from_drdy = false;
+    in_flight.store(BusCount, std::memory_order_release);
+    scheduled = true;
+
+    if (drdy_active)
+    {
+        armed.store(true, std::memory_order_release);
+        return;
+    }
+    const int32_t delay_us = static_cast<int32_t>(due_us - lead_us - micros());
+    if (delay_us <= 0)
+        acq_timer_cb(nullptr);
+    else
+        esp_timer_start_once(acq_timer, delay_us);
+}
+
+void my_acq_take(hal_sense_snapshot &out)
+{
+    if (!scheduled)
+    {
+        read_sync(out);
+        last_snap = out;
+        return;
+    }
+
+    // frame_ready 只是唤醒信号（可能来自到时定时器或上一帧的迟到通知），帧是否完成以 in_flight 为准；
+    // tick 超时仅作定时器失效时的兜底
+    if (in_flight.load(std::memory_order_acquire) != 0)
+    {
+        const int64_t deadline = esp_timer_get_time() + wait_us;
+        esp_timer_start_once(wait_timer, wait_us);
+        while (in_flight.load(std::memory_order_acquire) != 0 && esp_timer_get_time() < deadline)
+            xSemaphoreTake(frame_ready, pdMS_TO_TICKS(ACQ_WAIT_US / 1000) + 1);
+        esp_timer_stop(wait_timer);
+    }
+    if (in_flight.load(std::memory_order_acquire) != 0)
+    {
+        // 在途帧未完成：沿用上一帧，帧到达后下个周期再取；持续取不到视为失联
+        misses++;
+        out = last_snap;
+        if (++miss_streak >= ACQ_MISS_FAULT)
+            out.alive = false;
+        return;
+    }
+
+    xSemaphoreTake(frame_ready, 0); // 清掉本帧的完成通知
+    scheduled = false;
+    miss_streak = 0;
+    assemble(out);
+    last_snap = out;
+    frames++;
+}
+
+uint32_t my_acq_frames()
+{
+    return frames;
+}
+
+uint32_t my_acq_misses()
+{
+    return misses;
+}
+
+uint32_t my_acq_lead_us()
+{
+    return lead_us;
+}
+
+uint32_t my_acq_wait_us()
+{
+    return wait_us;
+}
+// 说明：双 I2C 总线并行的传感器采集流水线，由定时器预取或 IMU 数据就绪中断触发，交接带时间戳的快照
@@ -0,0 +1,61 @@
+#include <Arduino.h>
+#include <atomic>
+#include "my_boot.h"
+
+namespace
+{
+struct span_slot
+{
+    std::atomic<uint32_t> start_ms{0};
+    std::atomic<uint32_t> end_ms{0};
+};
+
+span_slot spans[static_cast<uint8_t>(BootStage::Count)];
+
+// 上电后 1ms 内的时刻记为 1，保留 0 表示未发生
+uint32_t stamp()
+{
+    const uint32_t now = millis();
+    return now ? now : 1;
+}
+} // namespace
+
+void boot_begin(BootStage stage)
+{
+    spans[static_cast<uint8_t>(stage)].start_ms.store(stamp(), std::memory_order_relaxed);
+}
+
+void boot_end(BootStage stage)
+{
+    spans[static_cast<uint8_t>(stage)].end_ms.store(stamp(), std::memory_order_relaxed);
+}
+
+void boot_mark(BootStage stage)
+{
+    const uint32_t t = stamp();
+    span_slot &s = spans[static_cast<uint8_t>(stage)];
+    s.start_ms.store(t, std::memory_order_relaxed);
+    s.end_ms.store(t, std::memory_order_relaxed);
+}
+
+boot_span boot_get(BootStage stage)
+{
+    const span_slot &s = spans[static_cast<uint8_t>(stage)];
+    return boot_span{s.start_ms.load(std::memory_order_relaxed), s.end_ms.load(std::memory_order_relaxed)};
+}
+
+const char *boot_stage_name(BootStage stage)
+{
+    switch (stage)
+    {
+    case BootStage::Net: return "net";
+    case BootStage::Screen: return "screen";
+    case BootStage::Imu: return "imu";
+    case BootStage::MotorL: return "motor_l";
+    case BootStage::MotorR: return "motor_r";
+    case BootStage::Control: return "control";
+    case BootStage::Balance: return "balance";
+    default: return "unknown";
+    }
+}
+// 说明：启动阶段时间线记录，供并行启动调优与网页端展示
@@ -1,9 +1,13 @@
 #include "Arduino.h"
+#include <atomic>
+#include <esp_timer.h>
 #include "my_foc.h"
 #include "my_i2c.h"
 #include "my_config.h"
-#include "my_motion.h"
 #include "my_bat.h"
+#include "my_seqlock.h"
+#include "my_boot.h"
+#include "my_storage.h"
 
 BLDCMotor motor_1 = BLDCMotor(7);
 BLDCMotor motor_2 = BLDCMotor(7);
@@ -14,24 +18,271 @@ MagneticSensorI2C sensor_2 = MagneticSensorI2C(AS5600_I2C);
 BLDCDriver3PWM driver_1(DRIVER1_IN1, DRIVER1_IN2, DRIVER1_IN3, DRIVER_EN);
 BLDCDriver3PWM driver_2(DRIVER2_IN1, DRIVER2_IN2, DRIVER2_IN3, DRIVER_EN);
 
-// 根据实时电池电压调整驱动供电参数，避免电量高低导致力感变化
-static inline void update_supply_from_battery()
+namespace
+{
+seqlock<foc_targets> targets_slot;
+seqlock<foc_feedback> feedback_slot;
+TaskHandle_t foc_task_handle = nullptr;
+esp_timer_handle_t foc_timer = nullptr;
+volatile bool foc_running = false;
+std::atomic<bool> hold{false}; // 重新初始化电机期间暂停换相
+std::atomic<bool> held{false};
+uint32_t foc_loops = 0;
+constexpr uint32_t PERIOD_US = FOC_LOOP_US > 0 ? FOC_LOOP_US : 1; // 为 0 时任务不启动，仅防除零
+std::atomic<uint32_t> foc_overruns{0};
+std::atomic<uint32_t> foc_busy_us{0};
+std::atomic<uint32_t> foc_max_busy_us{0};
+std::atomic<float> foc_rate_hz{0.0f};
+
+// 未初始化时用满电作为兜底，输出上限预留 15% 余量
+foc_targets idle_targets()
 {
-    // 未初始化时用满电作为兜底
     const float supply = (battery_voltage > 1.0f) ? battery_voltage : BAT_FULL_VOLTAGE;
+    return foc_targets{HalMotorLoop::Torque, 0.0f, 0.0f, supply, supply * 0.85f};
+}
+
+MotionControlType to_controller(HalMotorLoop loop)
+{
+    switch (loop)
+    {
+    case HalMotorLoop::Velocity: return MotionControlType::velocity;
+    case HalMotorLoop::Angle: return MotionControlType::angle;
+    case HalMotorLoop::Torque:
+    default: return MotionControlType::torque;
+    }
+}
+
+// 执行一次换相并发布编码器反馈
+void commutate(const foc_targets &t)
+{
+    driver_1.voltage_power_supply = t.supply_v;
+    driver_2.voltage_power_supply = t.supply_v;
+    motor_1.voltage_limit = t.voltage_limit;
+    motor_2.voltage_limit = t.voltage_limit;
+
+    const MotionControlType ctrl = to_controller(t.loop);
+    motor_1.controller = ctrl;
+    motor_2.controller = ctrl;
+    motor_1.target = t.L;
+    motor_2.target = t.R;
+
+    motor_1.loopFOC();
+    i2c1_hi_begin_periodic(I2cDev::As5600R);
+    motor_2.loopFOC(); // 读右编码器
+    i2c1_hi_end();
+
+    motor_1.move();
+    motor_2.move();
+
+    foc_feedback fb;
+    fb.rot_L = sensor_1.getFullRotations();
+    fb.rot_R = sensor_2.getFullRotations();
+    fb.mech_L = sensor_1.getMechanicalAngle();
+    fb.mech_R = sensor_2.getMechanicalAngle();
+    fb.ts_us = micros();
+    fb.loops = ++foc_loops;
+    feedback_slot.store(fb);
+}
+
+// esp_timer 回调只负责唤醒换相任务
+void foc_timer_cb(void *)
+{
+    if (foc_task_handle)
+        xTaskNotifyGive(foc_task_handle);
+}
+
+// 换相任务：定时器节拍驱动，读取最新目标（读不到一致数据时沿用上一份）
+// 定时器积压的节拍被 skip_unhandled_events 合并，这里按实际间隔补记
+void foc_task(void *)
+{
+    foc_targets cur = idle_targets();
+    uint32_t prev_us = 0;
+    uint32_t win_us = 0;
+    uint32_t win_loops = 0;
+    for (;;)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        if (hold.load(std::memory_order_acquire))
+        {
+            held.store(true, std::memory_order_release);
+            prev_us = win_us = 0;
+            win_loops = 0;
+            continue;
+        }
+        held.store(false, std::memory_order_relaxed);
+        foc_targets t;
+        if (targets_slot.try_load(t))
+            cur = t;
+
+        const uint32_t t0 = micros();
+        if (prev_us != 0 && t0 - prev_us > PERIOD_US + PERIOD_US / 2)
+            foc_overruns.fetch_add((t0 - prev_us + PERIOD_US / 2) / PERIOD_US - 1, std::memory_order_relaxed);
+        prev_us = t0;
+
+        commutate(cur);
+
+        const uint32_t busy = micros() - t0;
+        foc_busy_us.store(busy, std::memory_order_relaxed);
+        if (busy > foc_max_busy_us.load(std::memory_order_relaxed))
+            foc_max_busy_us.store(busy, std::memory_order_relaxed);
+        if (win_us == 0)
+            win_us = t0;
+        else
+            ++win_loops;
+        if (t0 - win_us >= 1000000U)
+        {
+            foc_rate_hz.store(win_loops * 1e6f / (t0 - win_us), std::memory_order_relaxed);
+            win_us = t0;
+            win_loops = 0;
+        }
+    }
+}
+
+// 每个电机的对齐所需对象；序号同时作为存档键
+struct motor_unit
+{
+    BLDCMotor &motor;
+    MagneticSensorI2C &sensor;
+    TwoWire &wire;
+    BootStage stage;
+    bool shared; // 编码器所在总线与屏幕共用，访问须经 Wire1 仲裁
+};
+
+motor_unit units[2] = {
+    {motor_1, sensor_1, Wire0, BootStage::MotorL, false},
+    {motor_2, sensor_2, Wire1, BootStage::MotorR, true},
+};
+
+// 对齐与开机动画并行，右电机的 Wire1 访问同样按控制侧事务仲裁
+void bus_begin(const motor_unit &u)
+{
+    if (u.shared)
+        i2c1_hi_begin(I2cDev::As5600R);
+}
+
+void bus_end(const motor_unit &u)
+{
+    if (u.shared)
+        i2c1_hi_end();
+}
+
+bool realign_req = false;
+
+// AS5600 STATUS：MD 置位且 ML/MH 均未置位表示磁铁在位、强度合适
+bool magnet_ok(const motor_unit &u)
+{
+    TwoWire &w = u.wire;
+    bus_begin(u);
+    w.beginTransmission(ADDR_AS5600);
+    w.write(AS5600_REG_STATUS);
+    const bool read = w.endTransmission(false) == 0 &&
+                      w.requestFrom(static_cast<uint8_t>(ADDR_AS5600), static_cast<uint8_t>(1)) == 1;
+    const uint8_t st = read ? static_cast<uint8_t>(w.read()) : 0;
+    bus_end(u);
+    return read && (st & 0x20) && !(st & 0x18);
+}
+
+// initFOC 内部的编码器读取无法逐次仲裁，整段持有总线（屏幕在此期间暂停刷新）
+bool init_foc(motor_unit &u)
+{
+    bus_begin(u);
+    const bool ok = u.motor.initFOC();
+    bus_end(u);
+    return ok;
+}
+
+void sensor_update(motor_unit &u)
+{
+    bus_begin(u);
+    u.sensor.update();
+    bus_end(u);
+}
 
-    driver_1.voltage_power_supply = supply;
-    driver_2.voltage_power_supply = supply;
+// 以存档参数施加短暂的正、反向力矩，转子须随之正、反转，否则零电角或方向已失效
+bool nudge_ok(motor_unit &u)
+{
+    const float uq[2] = {FOC_NUDGE_V, -FOC_NUDGE_V};
+    float moved[2];
+    for (uint8_t i = 0; i < 2; ++i)
+    {
+        sensor_update(u);
+        const float a0 = u.sensor.getAngle();
+        const uint32_t t0 = millis();
+        while (millis() - t0 < FOC_NUDGE_MS)
+        {
+            sensor_update(u);
+            u.motor.setPhaseVoltage(uq[i], 0, u.motor.electricalAngle());
+            // 让出 CPU：同核的另一路对齐与屏幕任务照常运行，试探期间转速很低，1 tick 更新一次电角足够
+            vTaskDelay(1);
+        }
+        u.motor.setPhaseVoltage(0, 0, 0);
+        sensor_update(u);
+        moved[i] = u.motor.sensor_direction * (u.sensor.getAngle() - a0);
+    }
+    return moved[0] > FOC_NUDGE_MIN_RAD && moved[1] < -FOC_NUDGE_MIN_RAD;
+}
+
+// 优先使用存档的零电角与方向跳过扫描对齐，校验失败再完整对齐并存档
+void align_one(uint8_t idx, bool timeline)
+{
+    motor_unit &u = units[idx];
+    if (timeline)
+        boot_begin(u.stage);
+    u.motor.init();
 
-    // 将输出上限跟随供电，预留 15% 余量防止触顶
-    const float limit = supply * 0.85f;
-    motor_1.voltage_limit = limit;
-    motor_2.voltage_limit = limit;
+    float zero;
+    int8_t dir;
+    bool ok = false;
+    if (!realign_req && magnet_ok(u) && storage_load_foc_align(idx, zero, dir) && dir != 0)
+    {
+        u.motor.zero_electric_angle = zero;
+        u.motor.sensor_direction = dir > 0 ? Direction::CW : Direction::CCW;
+        ok = init_foc(u) && nudge_ok(u);
+        if (!ok)
+            Serial.printf("电机%u 对齐存档校验失败，重新对齐\n", idx + 1);
+    }
+    if (!ok)
+    {
+        u.motor.zero_electric_angle = NOT_SET;
+        u.motor.sensor_direction = Direction::UNKNOWN;
+        if (init_foc(u))
+            storage_save_foc_align(idx, u.motor.zero_electric_angle, static_cast<int8_t>(u.motor.sensor_direction));
+    }
+    if (timeline)
+        boot_end(u.stage);
+}
+
+// 右电机对齐放在调用者之外的另一个核上（启动时 setup 在核心 1，运行中重启在控制任务的核心 0）：
+// 两路编码器分属两条总线、驱动 PWM 通道互不相干
+struct align_job
+{
+    SemaphoreHandle_t done;
+    bool timeline;
+};
+
+void align_r_task(void *arg)
+{
+    align_job *job = static_cast<align_job *>(arg);
+    align_one(1, job->timeline);
+    xSemaphoreGive(job->done);
+    vTaskDelete(nullptr);
 }
+} // namespace
+
 void my_motor_init() { 
+    // 运行中重新初始化：先让换相任务停在节拍之间，避免与 initFOC 同时操作电机与编码器
+    const bool pause = foc_running;
+    if (pause)
+    {
+        hold.store(true, std::memory_order_release);
+        while (!held.load(std::memory_order_acquire))
+            vTaskDelay(1);
+    }
     // 初始化传感器
     sensor_1.init(&Wire0);
+    i2c1_hi_begin(I2cDev::As5600R); // init 会读一次角度，此时屏幕可能正在刷新
     sensor_2.init(&Wire1);
+    i2c1_hi_end();
     // 传感器与电机关联
     motor_1.linkSensor(&sensor_1);
     motor_2.linkSensor(&sensor_2);
@@ -51,60 +302,86 @@ void my_motor_init() {
     motor_1.voltage_sensor_align = 3.0f;
     motor_2.voltage_sensor_align = 3.0f;
 
-    update_supply_from_battery();
+    const foc_targets init = idle_targets();
+    driver_1.voltage_power_supply = init.supply_v;
+    driver_2.voltage_power_supply = init.supply_v;
+    motor_1.voltage_limit = init.voltage_limit;
+    motor_2.voltage_limit = init.voltage_limit;
 
     motor_1.useMonitoring(Serial);
     motor_2.useMonitoring(Serial);
 
-    motor_1.init();
-    motor_1.initFOC();
-    motor_2.init();
-    motor_2.initFOC();
+    // 左右电机对齐并行，耗时由两次 initFOC 之和降为较慢的一次
+    align_job job{xSemaphoreCreateBinary(), !pause};
+    const BaseType_t other_core = xPortGetCoreID() == 0 ? 1 : 0;
+    xTaskCreatePinnedToCore(align_r_task, "align_r", 4096, &job, configMAX_PRIORITIES - 2, nullptr, other_core);
+    align_one(0, job.timeline);
+    xSemaphoreTake(job.done, portMAX_DELAY);
+    vSemaphoreDelete(job.done);
+    realign_req = false;
+    if (pause)
+    {
+        targets_slot.store(idle_targets());
+        hold.store(false, std::memory_order_release);
+    }
     Serial.println("电机初始化完成");
 }
 
-void my_motor_update() {
-    update_supply_from_battery();
+void my_motor_forget_alignment()
+{
+    realign_req = true;
+    storage_clear_foc_align();
+}
+
+void my_foc_start_task()
+{
+    if (FOC_LOOP_US == 0 || foc_running)
+        return;
+    targets_slot.store(idle_targets());
+    xTaskCreatePinnedToCore(foc_task, "foc", FOC_TASK_STACK, nullptr, configMAX_PRIORITIES - 1, &foc_task_handle, FOC_TASK_CORE);
 
-    if (robot.state == MotionState::Test)
-    {
-        switch (robot.motor_mode)
-        {
-        case MODE_SPEED:
-            motor_1.controller = MotionControlType::velocity;
-            motor_2.controller = MotionControlType::velocity;
-            motor_1.target = robot.tor.L;
-            motor_2.target = robot.tor.R;
-            break;
-        case MODE_POS:
-            motor_1.controller = MotionControlType::angle;
-            motor_2.controller = MotionControlType::angle;
-            motor_1.target = robot.tor.L * (PI / 180.0f);
-            motor_2.target = robot.tor.R * (PI / 180.0f);
-            break;
-        case MODE_PWM:
-        default:
-            motor_1.controller = MotionControlType::torque;
-            motor_2.controller = MotionControlType::torque;
-            // Map -1000~1000 to -Limit~Limit
-            float limit = motor_1.voltage_limit;
-            motor_1.target = (robot.tor.L / 1000.0f) * limit;
-            motor_2.target = (robot.tor.R / 1000.0f) * limit;
-            break;
-        }
-    }
-    else
-    {
-        motor_1.controller = MotionControlType::torque;
-        motor_2.controller = MotionControlType::torque;
-        motor_1.target = robot.tor.L;
-        motor_2.target = robot.tor.R;
-    }
+    const esp_timer_create_args_t args = {
+        .callback = foc_timer_cb,
+        .arg = nullptr,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "foc",
+        .skip_unhandled_events = true,
+    };
+    esp_timer_create(&args, &foc_timer);
+    esp_timer_start_periodic(foc_timer, FOC_LOOP_US);
+    foc_running = true;
+}
 
-    motor_1.loopFOC();
-    motor_2.loopFOC();
+bool my_foc_task_running()
+{
+    return foc_running;
+}
 
-    motor_1.move();
-    motor_2.move();
+foc_stats my_foc_get_stats()
+{
+    foc_stats st;
+    st.loops = foc_loops;
+    st.overruns = foc_overruns.load(std::memory_order_relaxed);
+    st.rate_hz = foc_rate_hz.load(std::memory_order_relaxed);
+    st.busy_us = foc_busy_us.load(std::memory_order_relaxed);
+    st.max_busy_us = foc_max_busy_us.load(std::memory_order_relaxed);
+    return st;
+}
+
+void my_foc_set_targets(const foc_targets &t)
+{
+    targets_slot.store(t);
+}
+
+bool my_foc_get_feedback(foc_feedback &out)
+{
+    if (feedback_slot.version() == 0)
+        return false;
+    return feedback_slot.try_load(out);
+}
+
+void my_foc_step_inline(const foc_targets &t)
+{
+    commutate(t);
 }
-// 说明：基于 SimpleFOC 的无刷驱动配置与力矩输出（ESP32-S3）
+// 说明：基于 SimpleFOC 的无刷驱动初始化与独立高频换相任务（ESP32-S3），与平衡环经序列锁交接
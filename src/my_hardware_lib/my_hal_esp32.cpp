@@ -0,0 +1,136 @@
+#include <Arduino.h>
+#include <esp_attr.h>
+#include <esp_system.h>
+#include "my_hal.h"
+#include "my_config.h"
+#include "my_foc.h"
+#include "my_mpu6050.h"
+#include "my_i2c.h"
+#include "my_acq.h"
+
+namespace
+{
+foc_targets pending{HalMotorLoop::Torque, 0.0f, 0.0f, BAT_FULL_VOLTAGE, BAT_FULL_VOLTAGE * 0.85f};
+foc_feedback wheel_prev{};
+bool wheel_has_prev = false;
+// 上电时为随机值，软件复位/看门狗复位后保持不变
+RTC_NOINIT_ATTR uint8_t warm_mem[WARM_MEM_BYTES];
+float wheel_wL = 0.0f;
+float wheel_wR = 0.0f;
+} // namespace
+
+uint32_t hal_millis()
+{
+    return millis();
+}
+
+uint32_t hal_micros()
+{
+    return micros();
+}
+
+uint32_t hal_cycles()
+{
+    return ESP.getCycleCount();
+}
+
+uint32_t hal_cycles_per_us()
+{
+    return getCpuFrequencyMhz();
+}
+
+void hal_imu_read(hal_imu_sample &out, uint32_t &t_us)
+{
+    mpu6050_read(out, t_us);
+}
+
+// 换相任务运行时编码器由其独占，这里只对其发布的角度做差分（与平衡周期同尺度，噪声不变）
+void hal_wheel_read(float &wL, float &wR)
+{
+    if (!my_foc_task_running())
+    {
+        sensor_1.update();
+        i2c1_hi_begin(I2cDev::As5600R);
+        sensor_2.update();
+        i2c1_hi_end();
+        wL = sensor_1.getVelocity();
+        wR = sensor_2.getVelocity();
+        return;
+    }
+
+    foc_feedback fb;
+    if (my_foc_get_feedback(fb) && fb.loops != wheel_prev.loops)
+    {
+        const float dt = (fb.ts_us - wheel_prev.ts_us) * 1e-6f;
+        if (wheel_has_prev && dt > 0.0f)
+        {
+            wheel_wL = ((fb.rot_L - wheel_prev.rot_L) * _2PI + (fb.mech_L - wheel_prev.mech_L)) / dt;
+            wheel_wR = ((fb.rot_R - wheel_prev.rot_R) * _2PI + (fb.mech_R - wheel_prev.mech_R)) / dt;
+        }
+        wheel_prev = fb;
+        wheel_has_prev = true;
+    }
+    wL = wheel_wL;
+    wR = wheel_wR;
+}
+
+// 快照由采集流水线交接（两路总线已在上一周期末并行读取）
+void hal_sense_read(hal_sense_snapshot &out)
+{
+    my_acq_take(out);
+}
+
+void hal_motor_set_supply(float supply_v, float voltage_limit)
+{
+    pending.supply_v = supply_v;
+    pending.voltage_limit = voltage_limit;
+}
+
+// 换相任务运行时只交接目标，否则在平衡环内直接换相
+void hal_motor_output(HalMotorLoop loop, float target_L, float target_R)
+{
+    pending.loop = loop;
+    pending.L = target_L;
+    pending.R = target_R;
+    if (my_foc_task_running())
+        my_foc_set_targets(pending);
+    else
+        my_foc_step_inline(pending);
+}
+
+// I2C 设备应答检测：MPU6050 与左右 AS5600（两路总线）
+bool hal_sensors_alive()
+{
+    auto ping = [](TwoWire &w, uint8_t addr) {
+        w.beginTransmission(addr);
+        return w.endTransmission() == 0;
+    };
+
+    bool ok_mpu = ping(Wire0, ADDR_MPU6050);
+    bool ok_as_l = ping(Wire0, ADDR_AS5600);
+    i2c1_hi_begin(I2cDev::As5600R);
+    bool ok_as_r = ping(Wire1, ADDR_AS5600);
+    i2c1_hi_end();
+    return ok_mpu && ok_as_l && ok_as_r;
+}
+
+uint8_t *hal_warm_mem()
+{
+    return warm_mem;
+}
+
+bool hal_warm_reset()
+{
+    switch (esp_reset_reason())
+    {
+    case ESP_RST_SW:
+    case ESP_RST_PANIC:
+    case ESP_RST_INT_WDT:
+    case ESP_RST_TASK_WDT:
+    case ESP_RST_WDT:
+        return true;
+    default:
+        return false;
+    }
+}
+// 说明：my_hal 的 ESP32-S3 实现，对接 Arduino 时钟、MPU6050、AS5600、采集流水线与 SimpleFOC 换相任务
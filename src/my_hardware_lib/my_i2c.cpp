@@ -1,10 +1,163 @@
 #include <Arduino.h>
+#include <atomic>
 #include "my_i2c.h"
 #include "my_config.h"
 
+namespace
+{
+SemaphoreHandle_t bus1 = nullptr;
+std::atomic<uint8_t> hi_waiting{0};
+std::atomic<TaskHandle_t> bg_waiter{nullptr};
+
+// 以下在持有 bus1 时读写
+uint32_t hi_start_us = 0;
+uint32_t hi_period_us = 0; // 相邻两次周期性控制侧事务开始的间隔
+
+struct wait_acc
+{
+    std::atomic<uint32_t> n{0};
+    std::atomic<uint32_t> sum_us{0};
+    std::atomic<uint32_t> max_us{0};
+};
+wait_acc waits[static_cast<uint8_t>(I2cDev::Count)];
+
+void record_wait(I2cDev dev, uint32_t us)
+{
+    wait_acc &w = waits[static_cast<uint8_t>(dev)];
+    w.n.fetch_add(1, std::memory_order_relaxed);
+    w.sum_us.fetch_add(us, std::memory_order_relaxed);
+    if (us > w.max_us.load(std::memory_order_relaxed))
+        w.max_us.store(us, std::memory_order_relaxed);
+}
+
+// 每字节 9 位，另计地址字节、控制字节与起止位，再加驱动的单次事务开销
+uint32_t tx_us(size_t bytes)
+{
+    return static_cast<uint32_t>(((bytes + 2) * 9 + 2) * 1000000ULL / I2C_FREQUENCY) + I2C1_TXN_OVERHEAD_US;
+}
+
+// 距下一次控制侧事务预计还剩多少空档（us）；控制侧流量已停时视为不限
+uint32_t gap_us()
+{
+    if (hi_period_us == 0)
+        return UINT32_MAX;
+    const uint32_t since = micros() - hi_start_us;
+    if (since >= 2 * hi_period_us)
+        return UINT32_MAX;
+    const uint32_t next = hi_period_us > I2C1_GUARD_US ? hi_period_us - I2C1_GUARD_US : 0;
+    return since < next ? next - since : 0;
+}
+
+// 空档内最多能发的数据字节数
+size_t fit_bytes(uint32_t gap)
+{
+    size_t n = I2C1_BG_CHUNK;
+    while (n > 0 && tx_us(n) > gap)
+        --n;
+    return n;
+}
+
+// 取得总线并返回本块可发字节数；空档过小则等控制侧释放时唤醒。
+// 等待超过 I2C1_BG_STARVE_US 后，只在被 i2c1_hi_end 唤醒（离下一次编码器读取最远）时放行 1 字节，避免后台饿死
+size_t bg_acquire(I2cDev dev, size_t want)
+{
+    const uint32_t t0 = micros();
+    bool after_end = false;
+    for (;;)
+    {
+        xSemaphoreTake(bus1, portMAX_DELAY);
+        if (hi_waiting.load(std::memory_order_acquire) == 0)
+        {
+            size_t n = fit_bytes(gap_us());
+            if (n == 0 && after_end)
+                n = 1;
+            if (n > 0)
+            {
+                record_wait(dev, micros() - t0);
+                return n < want ? n : want;
+            }
+        }
+        bg_waiter.store(xTaskGetCurrentTaskHandle(), std::memory_order_release);
+        xSemaphoreGive(bus1);
+        const bool woken = ulTaskNotifyTake(pdTRUE, 1) > 0;
+        after_end = woken && micros() - t0 >= I2C1_BG_STARVE_US;
+    }
+}
+
+uint32_t hi_take(I2cDev dev)
+{
+    const uint32_t t0 = micros();
+    hi_waiting.fetch_add(1, std::memory_order_acq_rel);
+    xSemaphoreTake(bus1, portMAX_DELAY);
+    hi_waiting.fetch_sub(1, std::memory_order_acq_rel);
+    const uint32_t now = micros();
+    record_wait(dev, now - t0);
+    return now;
+}
+} // namespace
+
 void my_i2c_init()
 {
     Wire0.begin(I2C_SDA_1, I2C_SCL_1, I2C_FREQUENCY);
     Wire1.begin(I2C_SDA_2, I2C_SCL_2, I2C_FREQUENCY);
+    if (!bus1)
+        bus1 = xSemaphoreCreateMutex();
+}
+
+void i2c1_hi_begin(I2cDev dev)
+{
+    hi_take(dev);
+}
+
+void i2c1_hi_begin_periodic(I2cDev dev)
+{
+    const uint32_t now = hi_take(dev);
+    if (hi_start_us != 0)
+        hi_period_us = now - hi_start_us;
+    hi_start_us = now;
+}
+
+void i2c1_hi_end()
+{
+    xSemaphoreGive(bus1);
+    // 刚读完编码器，离下一次最远，立刻放行等待中的后台块
+    TaskHandle_t t = bg_waiter.exchange(nullptr, std::memory_order_acq_rel);
+    if (t)
+        xTaskNotifyGive(t);
+}
+
+void i2c1_bg_write(I2cDev dev, uint8_t addr, uint8_t prefix, const uint8_t *data, size_t len)
+{
+    while (len > 0)
+    {
+        const size_t n = bg_acquire(dev, len);
+        Wire1.beginTransmission(addr);
+        Wire1.write(prefix);
+        Wire1.write(data, n);
+        Wire1.endTransmission();
+        xSemaphoreGive(bus1);
+        data += n;
+        len -= n;
+    }
+}
+
+i2c_wait_stats i2c1_wait_stats(I2cDev dev)
+{
+    const wait_acc &w = waits[static_cast<uint8_t>(dev)];
+    i2c_wait_stats s;
+    s.n = w.n.load(std::memory_order_relaxed);
+    s.avg_us = s.n ? w.sum_us.load(std::memory_order_relaxed) / s.n : 0;
+    s.max_us = w.max_us.load(std::memory_order_relaxed);
+    return s;
+}
+
+const char *i2c_dev_name(I2cDev dev)
+{
+    switch (dev)
+    {
+    case I2cDev::As5600R: return "as5600_r";
+    case I2cDev::Screen: return "screen";
+    default: return "unknown";
+    }
 }
-// 说明：初始化双 I2C 总线（Wire0/Wire1）供传感器与外设使用
+// 说明：初始化双 I2C 总线（Wire0/Wire1），并对 Wire1 上的编码器与屏幕做优先级仲裁与等待统计
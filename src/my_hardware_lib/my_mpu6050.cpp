@@ -1,136 +1,182 @@
-#include "my_motion.h"
 #include "my_mpu6050.h"
+#include "my_ahrs.h"
+#include "my_warm.h"
+#include "my_hal.h"
 #include "my_i2c.h"
 #include "my_config.h"
 #include "Arduino.h"
-#include <cmath>
 
-MPU6050 mpu6050 = MPU6050(Wire0);
-
-// ==================== Mahony AHRS 滤波器 ====================
-static float mq0 = 1.0f, mq1 = 0.0f, mq2 = 0.0f, mq3 = 0.0f;
-static float meIx = 0.0f, meIy = 0.0f, meIz = 0.0f;
-static uint32_t mahony_last_us = 0;
-static bool mahony_inited = false;
-
-static void mahony_init_from_accel(float ax, float ay, float az)
+namespace
 {
-    float roll  = atan2f(ay, az);
-    float pitch = atan2f(-ax, sqrtf(ay * ay + az * az));
-    float cr = cosf(roll  * 0.5f), sr = sinf(roll  * 0.5f);
-    float cp = cosf(pitch * 0.5f), sp = sinf(pitch * 0.5f);
-    mq0 =  cr * cp;
-    mq1 =  sr * cp;
-    mq2 =  cr * sp;
-    mq3 = -sr * sp;
-    meIx = meIy = meIz = 0.0f;
+// 寄存器
+constexpr uint8_t REG_SMPLRT_DIV = 0x19;
+constexpr uint8_t REG_CONFIG = 0x1A;
+constexpr uint8_t REG_GYRO_CONFIG = 0x1B;
+constexpr uint8_t REG_ACCEL_CONFIG = 0x1C;
+constexpr uint8_t REG_INT_PIN_CFG = 0x37;
+constexpr uint8_t REG_INT_ENABLE = 0x38;
+constexpr uint8_t REG_ACCEL_XOUT_H = 0x3B; // 连续 14 字节：ACC xyz / TEMP / GYRO xyz
+constexpr uint8_t REG_PWR_MGMT_1 = 0x6B;
+constexpr uint8_t REG_WHO_AM_I = 0x75;
+constexpr uint8_t FRAME_LEN = 14;
+
+TwoWire *bus = nullptr;
+float acc_per_lsb = 1.0f / 16384.0f; // g/LSB
+float gyro_per_lsb = 1.0f / 65.5f;   // (deg/s)/LSB
+float gyro_off_x = 0.0f, gyro_off_y = 0.0f, gyro_off_z = 0.0f;
+hal_imu_sample last{0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f};
+MpuDlpf dlpf = MpuDlpf::Hz256;
+bool drdy_enabled = false; // 重新初始化后恢复数据就绪配置
+uint16_t drdy_rate_hz = 0;
+
+bool write_reg(uint8_t reg, uint8_t val)
+{
+    bus->beginTransmission(ADDR_MPU6050);
+    bus->write(reg);
+    bus->write(val);
+    return bus->endTransmission() == 0;
 }
 
-static void mahony_update(float ax, float ay, float az,
-                          float gx_dps, float gy_dps, float gz_dps)
+// 写寄存器地址后重复起始连续读
+bool read_regs(uint8_t reg, uint8_t *buf, uint8_t len)
 {
-    uint32_t now_us = micros();
-    float dt = (mahony_last_us == 0) ? 0.002f : (now_us - mahony_last_us) * 1e-6f;
-    mahony_last_us = now_us;
-    if (dt <= 0.0f || dt > 0.1f) dt = 0.002f;
-
-    constexpr float D2R = PI / 180.0f;
-    float gx = gx_dps * D2R;
-    float gy = gy_dps * D2R;
-    float gz = gz_dps * D2R;
-
-    float norm = sqrtf(ax * ax + ay * ay + az * az);
-    if (norm < 0.01f) goto integrate;
-    {
-        float inv = 1.0f / norm;
-        ax *= inv; ay *= inv; az *= inv;
-
-        float vx = 2.0f * (mq1 * mq3 - mq0 * mq2);
-        float vy = 2.0f * (mq0 * mq1 + mq2 * mq3);
-        float vz = mq0 * mq0 - mq1 * mq1 - mq2 * mq2 + mq3 * mq3;
-
-        float ex = ay * vz - az * vy;
-        float ey = az * vx - ax * vz;
-        float ez = ax * vy - ay * vx;
-
-        meIx += ex * MAHONY_KI * dt;
-        meIy += ey * MAHONY_KI * dt;
-        meIz += ez * MAHONY_KI * dt;
-
-        gx += MAHONY_KP * ex + meIx;
-        gy += MAHONY_KP * ey + meIy;
-        gz += MAHONY_KP * ez + meIz;
-    }
-integrate:
-    {
-        float hdt = 0.5f * dt;
-        float dq0 = (-mq1 * gx - mq2 * gy - mq3 * gz) * hdt;
-        float dq1 = ( mq0 * gx + mq2 * gz - mq3 * gy) * hdt;
-        float dq2 = ( mq0 * gy - mq1 * gz + mq3 * gx) * hdt;
-        float dq3 = ( mq0 * gz + mq1 * gy - mq2 * gx) * hdt;
-        mq0 += dq0; mq1 += dq1; mq2 += dq2; mq3 += dq3;
-
-        float qn = 1.0f / sqrtf(mq0 * mq0 + mq1 * mq1 + mq2 * mq2 + mq3 * mq3);
-        mq0 *= qn; mq1 *= qn; mq2 *= qn; mq3 *= qn;
-    }
+    bus->beginTransmission(ADDR_MPU6050);
+    bus->write(reg);
+    if (bus->endTransmission(false) != 0)
+        return false;
+    if (bus->requestFrom(static_cast<uint8_t>(ADDR_MPU6050), len) != len)
+        return false;
+    for (uint8_t i = 0; i < len; ++i)
+        buf[i] = static_cast<uint8_t>(bus->read());
+    return true;
 }
 
-static float mahony_pitch_deg()
+int16_t be16(const uint8_t *p)
 {
-    float sinp = 2.0f * (mq0 * mq2 - mq3 * mq1);
-    if (sinp > 1.0f)  sinp = 1.0f;
-    if (sinp < -1.0f) sinp = -1.0f;
-    return asinf(sinp) * (180.0f / PI);
+    return static_cast<int16_t>((p[0] << 8) | p[1]);
 }
 
-static float mahony_roll_deg()
+// 读原始帧并按量程换算，不扣零偏
+bool read_scaled(hal_imu_sample &s)
 {
-    return atan2f(2.0f * (mq0 * mq1 + mq2 * mq3),
-                  1.0f - 2.0f * (mq1 * mq1 + mq2 * mq2)) * (180.0f / PI);
+    uint8_t raw[FRAME_LEN];
+    if (!bus || !read_regs(REG_ACCEL_XOUT_H, raw, FRAME_LEN))
+        return false;
+    s.ax = be16(raw + 0) * acc_per_lsb;
+    s.ay = be16(raw + 2) * acc_per_lsb;
+    s.az = be16(raw + 4) * acc_per_lsb;
+    s.gx = be16(raw + 8) * gyro_per_lsb;
+    s.gy = be16(raw + 10) * gyro_per_lsb;
+    s.gz = be16(raw + 12) * gyro_per_lsb;
+    return true;
 }
+} // namespace
 
-static float mahony_yaw_deg()
+bool mpu6050_begin(TwoWire &wire, const mpu6050_config &cfg)
 {
-    return atan2f(2.0f * (mq0 * mq3 + mq1 * mq2),
-                  1.0f - 2.0f * (mq2 * mq2 + mq3 * mq3)) * (180.0f / PI);
+    bus = &wire;
+    uint8_t who = 0;
+    if (!read_regs(REG_WHO_AM_I, &who, 1))
+        return false;
+    if (who != 0x68)
+        Serial.printf("MPU6050 WHO_AM_I=0x%02X，按兼容芯片继续\n", who);
+
+    // 时钟取 X 轴陀螺 PLL，比内部 RC 稳定
+    bool ok = write_reg(REG_PWR_MGMT_1, 0x01);
+    ok = ok && write_reg(REG_SMPLRT_DIV, cfg.sample_div);
+    ok = ok && write_reg(REG_CONFIG, static_cast<uint8_t>(cfg.dlpf) & 0x07);
+    ok = ok && write_reg(REG_GYRO_CONFIG, static_cast<uint8_t>(cfg.gyro_range) << 3);
+    ok = ok && write_reg(REG_ACCEL_CONFIG, static_cast<uint8_t>(cfg.accel_range) << 3);
+    dlpf = cfg.dlpf;
+
+    // 满量程每档翻倍：±2g → 16384 LSB/g，±250dps → 131 LSB/(deg/s)
+    acc_per_lsb = static_cast<float>(1U << static_cast<uint8_t>(cfg.accel_range)) / 16384.0f;
+    gyro_per_lsb = static_cast<float>(1U << static_cast<uint8_t>(cfg.gyro_range)) / 131.0f;
+    if (ok && drdy_enabled)
+        ok = mpu6050_enable_data_ready(drdy_rate_hz);
+    return ok;
 }
 
-// ==================== 公共接口 ====================
-
-void my_mpu6050_init()
+bool mpu6050_enable_data_ready(uint16_t rate_hz)
 {
-    mpu6050.begin();
-    mpu6050.calcGyroOffsets(true);
-    delay(1000);
-    mahony_inited = false;
-    mahony_last_us = 0;
-    Serial.println("MPU6050初始化完成");
+    if (!bus || rate_hz == 0)
+        return false;
+    // 低通关闭时陀螺内部 8kHz，否则 1kHz
+    const uint16_t base_hz = (dlpf == MpuDlpf::Hz256) ? 8000 : 1000;
+    uint16_t div = base_hz / rate_hz;
+    div = (div == 0) ? 0 : div - 1;
+    if (div > 255)
+        div = 255;
+
+    // INT 推挽高电平脉冲，读任意寄存器即清除
+    bool ok = write_reg(REG_SMPLRT_DIV, static_cast<uint8_t>(div));
+    ok = ok && write_reg(REG_INT_PIN_CFG, 0x10);
+    ok = ok && write_reg(REG_INT_ENABLE, 0x01);
+    drdy_enabled = ok;
+    drdy_rate_hz = rate_hz;
+    return ok;
 }
 
-void my_mpu6050_update()
+bool mpu6050_read(hal_imu_sample &out, uint32_t &t_us)
 {
-    mpu6050.update();
-
-    float ax = mpu6050.getAccX();
-    float ay = mpu6050.getAccY();
-    float az = mpu6050.getAccZ();
-    float gx = mpu6050.getGyroX();
-    float gy = mpu6050.getGyroY();
-    float gz = mpu6050.getGyroZ();
-
-    if (!mahony_inited)
+    t_us = micros();
+    hal_imu_sample s;
+    if (read_scaled(s))
     {
-        mahony_init_from_accel(ax, ay, az);
-        mahony_inited = true;
+        s.gx -= gyro_off_x;
+        s.gy -= gyro_off_y;
+        s.gz -= gyro_off_z;
+        last = s;
+        out = s;
+        return true;
     }
+    out = last;
+    return false;
+}
 
-    mahony_update(ax, ay, az, gx, gy, gz);
+void mpu6050_calc_gyro_offsets(uint16_t samples)
+{
+    float sx = 0.0f, sy = 0.0f, sz = 0.0f;
+    uint16_t n = 0;
+    for (uint16_t i = 0; i < samples; ++i)
+    {
+        hal_imu_sample s;
+        if (read_scaled(s))
+        {
+            sx += s.gx;
+            sy += s.gy;
+            sz += s.gz;
+            n++;
+        }
+        delay(1);
+    }
+    if (n == 0)
+        return;
+    gyro_off_x = sx / n;
+    gyro_off_y = sy / n;
+    gyro_off_z = sz / n;
+}
 
-    robot.imu.anglex = mahony_roll_deg();
-    robot.imu.angley = mahony_pitch_deg();
-    robot.imu.anglez = mahony_yaw_deg();
-    robot.imu.gyrox  = gx;
-    robot.imu.gyroy  = gy;
-    robot.imu.gyroz  = gz;
+void my_mpu6050_init()
+{
+    const mpu6050_config cfg{
+        static_cast<MpuDlpf>(MPU_DLPF_CFG),
+        static_cast<MpuGyroRange>(MPU_GYRO_FS),
+        static_cast<MpuAccelRange>(MPU_ACCEL_FS),
+        MPU_SMPLRT_DIV,
+    };
+    if (!mpu6050_begin(Wire0, cfg))
+        Serial.println("MPU6050无应答");
+    delay(100); // 等待 PLL 与低通稳定
+    // 热启动沿用上次的零偏，姿态已由 warm_restore 恢复，不复位 AHRS
+    if (warm_take_imu_offsets(gyro_off_x, gyro_off_y, gyro_off_z))
+    {
+        Serial.printf("MPU6050热启动 零偏=(%.2f, %.2f, %.2f) dps\n", gyro_off_x, gyro_off_y, gyro_off_z);
+        return;
+    }
+    mpu6050_calc_gyro_offsets(MPU_GYRO_CALIB_SAMPLES);
+    warm_set_imu_offsets(gyro_off_x, gyro_off_y, gyro_off_z);
+    ahrs_reset();
+    Serial.printf("MPU6050初始化完成 零偏=(%.2f, %.2f, %.2f) dps\n", gyro_off_x, gyro_off_y, gyro_off_z);
 }
-// 说明：MPU6050 IMU 初始化 + Mahony AHRS 姿态融合，将姿态数据写入机器人状态
+// 说明：MPU6050 片内驱动（突发读取、量程/低通配置、上电零偏），原始数据经采集流水线交给 Mahony AHRS 融合
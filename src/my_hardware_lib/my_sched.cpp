@@ -0,0 +1,95 @@
+#include "Arduino.h"
+#include <esp_timer.h>
+#include "my_sched.h"
+#include "my_config.h"
+
+static_assert(CONTROL_PERIOD_US >= CONTROL_PERIOD_MIN_US, "CONTROL_PERIOD_US below CONTROL_PERIOD_MIN_US");
+
+namespace
+{
+TaskHandle_t sched_task = nullptr;
+esp_timer_handle_t sched_timer = nullptr;
+uint32_t period_us = CONTROL_PERIOD_US;
+volatile bool external = false;
+int64_t next_due_us = 0; // 仅控制任务访问
+
+// 回调只负责唤醒控制任务
+void sched_timer_cb(void *)
+{
+    if (sched_task)
+        xTaskNotifyGive(sched_task);
+}
+
+void start_timer()
+{
+    next_due_us = esp_timer_get_time() + period_us;
+    esp_timer_start_periodic(sched_timer, period_us);
+}
+} // namespace
+
+void my_sched_start(TaskHandle_t task, uint32_t p_us)
+{
+    if (sched_timer)
+        return;
+    sched_task = task;
+    period_us = std::min<uint32_t>(std::max<uint32_t>(p_us, CONTROL_PERIOD_MIN_US), CONTROL_PERIOD_MAX_US);
+
+    const esp_timer_create_args_t args = {
+        .callback = sched_timer_cb,
+        .arg = nullptr,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "ctrl",
+        .skip_unhandled_events = true,
+    };
+    esp_timer_create(&args, &sched_timer);
+    if (!external)
+        start_timer();
+}
+
+uint32_t my_sched_period_us()
+{
+    return period_us;
+}
+
+uint32_t my_sched_wait()
+{
+    if (external)
+    {
+        // 每个数据就绪中断计一拍
+        return ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(MPU_DRDY_TIMEOUT_MS));
+    }
+
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    // 按预定节拍计数：控制任务超时时跳过的拍数也计入，dt 始终是周期的整数倍
+    const int64_t now = esp_timer_get_time();
+    uint32_t ticks = 1;
+    if (now >= next_due_us + period_us)
+        ticks += static_cast<uint32_t>((now - next_due_us) / period_us);
+    next_due_us += static_cast<int64_t>(ticks) * period_us;
+    return ticks;
+}
+
+uint32_t my_sched_next_us()
+{
+    return static_cast<uint32_t>(next_due_us);
+}
+
+void my_sched_use_external(bool ext)
+{
+    if (ext == external)
+        return;
+    external = ext;
+    if (!sched_timer)
+        return;
+    if (ext)
+        esp_timer_stop(sched_timer);
+    else
+        start_timer();
+}
+
+void IRAM_ATTR my_sched_tick_from_isr(BaseType_t *woken)
+{
+    if (sched_task)
+        vTaskNotifyGiveFromISR(sched_task, woken);
+}
+// 说明：平衡环微秒级周期调度，esp_timer 或 IMU 数据就绪中断作为节拍源，给出按节拍计的 dt
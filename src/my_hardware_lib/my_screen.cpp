@@ -3,6 +3,7 @@
 #include <Adafruit_GFX.h>
 #include <Adafruit_SSD1306.h>
 #include <string.h>
+#include <atomic>
 
 #include "my_screen.h"
 #include "my_motion.h"
@@ -11,6 +12,9 @@
 #include "my_bat.h"
 #include "my_i2c.h"
 #include "my_tool.h"
+#include "my_seqlock.h"
+#include "my_pixfmt.h"
+#include "my_boot.h"
 
 namespace
 {
@@ -48,9 +52,86 @@ static const uint8_t PROGMEM company_logo_bitmap[] = {
 0xfe
 };
 
-Adafruit_SSD1306 display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire1, -1);
-bool screen_ready = false;
+// 刷新前后都保持总线频率，库默认刷新后降到 100kHz 会拖慢同总线的右 AS5600
+Adafruit_SSD1306 display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire1, -1, I2C_FREQUENCY, I2C_FREQUENCY);
+bool display_found = false;
+bool screen_ready = false; // 开机动画播完后才刷新状态页、接受外部帧
 uint32_t last_frame = 0;
+TaskHandle_t screen_task = nullptr;
+
+// 与 SSD1306 显存同布局：page * SCREEN_WIDTH + col
+struct screen_pages
+{
+    uint8_t b[SCREEN_WIDTH * SCREEN_HEIGHT / 8];
+};
+
+// 外部帧：WS 回调在 ext_frame 上拼矩形后整帧发布，屏幕任务取到后直接作为显存
+screen_pages ext_frame;
+seqlock<screen_pages> ext_slot;
+uint32_t ext_seen = 0; // 以下仅屏幕任务访问
+uint32_t ext_last = 0;
+
+// 面板上当前内容的副本，刷新时与显存逐字节比对，只发送变化的列区间
+constexpr uint8_t PAGES = SCREEN_HEIGHT / 8;
+constexpr uint8_t MERGE_GAP = 8; // 两段变化之间未变字节少于此数时合并，省一次寻址
+uint8_t panel[SCREEN_WIDTH * PAGES];
+std::atomic<uint32_t> tx_bytes{0};
+
+// 水平寻址模式下设置窗口后连续写入；命令与数据都经 Wire1 仲裁拆块，在编码器读取间隙发出
+void send_span(uint8_t page, uint8_t c0, uint8_t c1, const uint8_t *data)
+{
+    const uint8_t window[] = {SSD1306_COLUMNADDR, c0, c1, SSD1306_PAGEADDR, page, page};
+    i2c1_bg_write(I2cDev::Screen, SCREEN_I2C_ADDRESS, 0x00, window, sizeof(window)); // 命令
+    i2c1_bg_write(I2cDev::Screen, SCREEN_I2C_ADDRESS, 0x40, data, c1 - c0 + 1);      // 显存数据
+}
+
+// 取代 display.display()：逐页找出变化区间，只写这些字节
+void flush_dirty()
+{
+    const uint8_t *buf = display.getBuffer();
+    uint32_t sent = 0;
+    for (uint8_t page = 0; page < PAGES; ++page)
+    {
+        const uint8_t *now = buf + page * SCREEN_WIDTH;
+        uint8_t *old = panel + page * SCREEN_WIDTH;
+        uint16_t x = 0;
+        while (x < SCREEN_WIDTH)
+        {
+            if (now[x] == old[x])
+            {
+                ++x;
+                continue;
+            }
+            const uint16_t c0 = x;
+            uint16_t c1 = x;
+            uint16_t same = 0;
+            while (++x < SCREEN_WIDTH && same < MERGE_GAP)
+            {
+                if (now[x] != old[x])
+                {
+                    c1 = x;
+                    same = 0;
+                }
+                else
+                {
+                    ++same;
+                }
+            }
+            x = c1 + 1;
+            send_span(page, c0, c1, now + c0);
+            memcpy(old + c0, now + c0, c1 - c0 + 1);
+            sent += c1 - c0 + 1;
+        }
+    }
+    tx_bytes.store(sent, std::memory_order_relaxed);
+}
+
+void publish_ext()
+{
+    ext_slot.store(ext_frame);
+    if (screen_task)
+        xTaskNotifyGive(screen_task);
+}
 
 // 五次缓入缓出
 static float ease_in_out_quint(float t)
@@ -92,38 +173,41 @@ void draw_header(uint8_t phase)
 void draw_status(uint8_t phase)
 {
     (void)phase;
+    robot_frame f;
+    if (!my_motion_snapshot(f))
+        return;
     display.setTextSize(1);
     display.setTextColor(SSD1306_WHITE);
 
     // 左侧：状态与电池
     display.setCursor(4, 2);
-    display.print(state_text(robot.state));
+    display.print(state_text(f.state));
 
     display.setCursor(50, 2);
-    display.print(robot.lowbat_warn ? "BAT! " : "BAT ");
-    display.print(battery_voltage, 1);
+    display.print(f.lowbat_warn ? "BAT! " : "BAT ");
+    display.print(f.batt_v, 1);
 
     // 中部：角度与扭矩
     display.setCursor(4, HEADER_H + 3);
     display.print("P:");
-    display.print(robot.ang.now, 1);
+    display.print(f.pitch, 1);
     display.setCursor(64, HEADER_H + 3);
     display.print("T:");
-    display.print(robot.tor.base, 1);
+    display.print(f.tor_base, 1);
 
     // 底部：离地/摔倒提示
     uint8_t y = HEADER_H + 15;
-    if (robot.drv_fault)
+    if (f.drv_fault)
     {
         display.setCursor(4, y);
         display.print("I2C FAULT");
     }
-    else if (robot.wel_up)
+    else if (f.wel_up)
     {
         display.setCursor(4, y);
         display.print("OFF-GROUND");
     }
-    else if (robot.fallen.is)
+    else if (f.fallen)
     {
         display.setCursor(4, y);
         display.print("FALLEN");
@@ -215,7 +299,7 @@ void play_boot()
         // 中心 Logo
         draw_center_logo(f, alpha);
 
-        display.display();
+        flush_dirty();
         delay(FRAME_DELAY);
     }
 }
@@ -229,17 +313,51 @@ void my_screen_init()
     {
         return;
     }
+    display_found = true;
     display.clearDisplay();
+    // 上电后面板内容未知：副本置为与显存全不同，整屏发送一次清屏
+    memset(panel, 0xFF, sizeof(panel));
+    flush_dirty();
+}
+
+void my_screen_play_boot()
+{
+    if (!display_found || screen_ready)
+        return;
+    boot_begin(BootStage::Screen);
     play_boot();
+    boot_end(BootStage::Screen);
     screen_ready = true;
     last_frame = millis();
 }
 
+void my_screen_attach(TaskHandle_t task)
+{
+    screen_task = task;
+}
+
 void my_screen_update()
 {
     if (!screen_ready)
         return;
     const uint32_t now = millis();
+
+    // 外部帧优先，期间暂停状态页，停止推送 SCREEN_EXT_HOLD_MS 后恢复
+    const uint32_t v = ext_slot.version();
+    if (v != ext_seen)
+    {
+        // 失败说明正被写入，写完会再次唤醒
+        if (ext_slot.try_load(*reinterpret_cast<screen_pages *>(display.getBuffer())))
+        {
+            ext_seen = v;
+            ext_last = now;
+            flush_dirty();
+        }
+        return;
+    }
+    if (ext_seen != 0 && now - ext_last < SCREEN_EXT_HOLD_MS)
+        return;
+
     if (now - last_frame < FRAME_INTERVAL_MS)
         return;
     last_frame = now;
@@ -250,10 +368,35 @@ void my_screen_update()
     display.clearDisplay();
     draw_header(phase);
     draw_status(phase);
-    display.display();
+    flush_dirty();
 }
 
-// 外部屏幕写入：支持 mono(1bpp) 与 rgb565 -> 灰度阈值
+uint32_t my_screen_tx_bytes()
+{
+    return tx_bytes.load(std::memory_order_relaxed);
+}
+
+bool my_screen_blit_pages(uint8_t page, uint8_t pages, uint8_t col, uint8_t cols, const uint8_t *data)
+{
+    if (!screen_ready || data == nullptr || pages == 0 || cols == 0)
+        return false;
+    if (page + pages > SCREEN_HEIGHT / 8 || col + cols > SCREEN_WIDTH)
+        return false;
+
+    if (col == 0 && cols == SCREEN_WIDTH)
+    {
+        memcpy(ext_frame.b + page * SCREEN_WIDTH, data, pages * SCREEN_WIDTH);
+    }
+    else
+    {
+        for (uint8_t p = 0; p < pages; ++p)
+            memcpy(ext_frame.b + (page + p) * SCREEN_WIDTH + col, data + p * cols, cols);
+    }
+    publish_ext();
+    return true;
+}
+
+// 外部屏幕写入：整帧转换为页格式后走外部帧通道，由屏幕任务刷新
 void my_screen_draw_buffer(const uint8_t *data, size_t len, uint16_t width, uint16_t height, const char *mode)
 {
     if (!screen_ready || data == nullptr)
@@ -261,56 +404,25 @@ void my_screen_draw_buffer(const uint8_t *data, size_t len, uint16_t width, uint
     if (width != SCREEN_WIDTH || height != SCREEN_HEIGHT)
         return;
 
-    display.clearDisplay();
-
     if (strcmp(mode, "mono") == 0)
     {
         // 1bpp，MSB first
-        const size_t expect = (size_t)width * height / 8;
-        if (len < expect)
+        if (len < (size_t)width * height / 8)
             return;
-        size_t idx = 0;
-        for (uint16_t y = 0; y < height; ++y)
-        {
-            for (uint16_t x = 0; x < width; x += 8)
-            {
-                uint8_t byte = data[idx++];
-                for (uint8_t b = 0; b < 8; ++b)
-                {
-                    bool on = byte & (1 << (7 - b));
-                    display.drawPixel(x + b, y, on ? SSD1306_WHITE : SSD1306_BLACK);
-                }
-            }
-        }
+        pix_mono_to_pages(data, ext_frame.b, width, height);
     }
-    else if (strcmp(mode, "rgb565") == 0)
+    else if (strcmp(mode, "rgb565") == 0 || strcmp(mode, "rgb565_dither") == 0)
     {
-        const size_t expect = (size_t)width * height * 2;
-        if (len < expect)
+        if (len < (size_t)width * height * 2)
             return;
-        size_t idx = 0;
-        for (uint16_t y = 0; y < height; ++y)
-        {
-            for (uint16_t x = 0; x < width; ++x)
-            {
-                uint8_t lo = data[idx++];
-                uint8_t hi = data[idx++];
-                uint16_t v = (hi << 8) | lo;
-                uint8_t r = (v >> 11) & 0x1F;
-                uint8_t g = (v >> 5) & 0x3F;
-                uint8_t b = v & 0x1F;
-                // 归一化到 0~255 近似，阈值化
-                uint16_t gray = (r * 527 + g * 259 + b * 527) >> 6; // 粗略 0~255*4
-                bool on = gray > 512; // 约 >50% 灰度
-                display.drawPixel(x, y, on ? SSD1306_WHITE : SSD1306_BLACK);
-            }
-        }
+        const bool dither = strcmp(mode, "rgb565_dither") == 0;
+        pix_rgb565_to_pages(data, ext_frame.b, width, height, dither);
     }
     else
     {
         return;
     }
 
-    display.display();
+    publish_ext();
 }
 // 说明：SSD1306 OLED 绘制，含开机动画、周期状态页与外部缓冲渲染
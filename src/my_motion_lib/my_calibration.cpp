@@ -1,7 +1,7 @@
-#include <Arduino.h>
 #include <cmath>
 #include "my_calibration.h"
 #include "my_storage.h"
+#include "my_hal.h"
 
 // 标定状态
 enum class CalibStage
@@ -76,7 +76,7 @@ bool calibration_done()
 
 bool calibration_step(robot_state &robot)
 {
-    const uint32_t now = millis();
+    const uint32_t now = hal_millis();
 
     if (calib_done_flag && !force_recalib_flag)
         return true;
@@ -0,0 +1,108 @@
+#include <atomic>
+#include "my_chart.h"
+#include "my_config.h"
+
+static_assert((CHART_RING_LEN & (CHART_RING_LEN - 1)) == 0, "CHART_RING_LEN must be a power of two");
+
+namespace
+{
+// 单生产者（控制任务）单消费者（ext 任务）
+chart_sample ring[CHART_RING_LEN];
+std::atomic<uint32_t> head{0};
+std::atomic<uint32_t> tail{0};
+std::atomic<bool> enabled{false};
+std::atomic<uint32_t> overflows{0};
+} // namespace
+
+void chart_capture_enable(bool on)
+{
+    if (on && !enabled.load(std::memory_order_relaxed))
+    {
+        // 重新打开时丢掉残留的旧样本，消费者独占 tail
+        tail.store(head.load(std::memory_order_acquire), std::memory_order_release);
+    }
+    enabled.store(on, std::memory_order_release);
+}
+
+bool chart_capture_enabled()
+{
+    return enabled.load(std::memory_order_relaxed);
+}
+
+void chart_push(const robot_frame &f)
+{
+    if (!enabled.load(std::memory_order_acquire))
+        return;
+    const uint32_t h = head.load(std::memory_order_relaxed);
+    if (h - tail.load(std::memory_order_acquire) >= CHART_RING_LEN)
+    {
+        overflows.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    chart_sample &s = ring[h & (CHART_RING_LEN - 1)];
+    s.seq = f.seq;
+    s.t_ms = f.t_ms;
+    s.v[CHART_ANG_TAR] = f.ang_tar;
+    s.v[CHART_PITCH] = f.pitch;
+    s.v[CHART_SPD_TAR] = f.spd_tar;
+    s.v[CHART_SPD_NOW] = f.spd_now;
+    s.v[CHART_TORQUE_L] = f.tor_L;
+    s.v[CHART_TORQUE_R] = f.tor_R;
+    s.v[CHART_SPEED_L] = f.wL;
+    s.v[CHART_SPEED_R] = f.wR;
+    s.v[CHART_GYRO_Y] = f.gyro_y;
+    s.v[CHART_ROLL] = f.roll;
+    s.v[CHART_YAW] = f.yaw;
+    s.v[CHART_ACC_Y] = f.pitch_raw;
+    s.v[CHART_DZ_L] = f.dzL;
+    s.v[CHART_DZ_R] = f.dzR;
+    s.v[CHART_BATT_V] = f.batt_v;
+    head.store(h + 1, std::memory_order_release);
+}
+
+size_t chart_pop(chart_sample *out, size_t max)
+{
+    const uint32_t h = head.load(std::memory_order_acquire);
+    uint32_t t = tail.load(std::memory_order_relaxed);
+    size_t n = 0;
+    // 一批只含序号连续的样本，批内时间轴可由首样本序号与周期推出
+    while (t != h && n < max)
+    {
+        const chart_sample &s = ring[t & (CHART_RING_LEN - 1)];
+        if (n > 0 && s.seq != out[n - 1].seq + 1)
+            break;
+        out[n++] = s;
+        ++t;
+    }
+    tail.store(t, std::memory_order_release);
+    return n;
+}
+
+uint32_t chart_overflows()
+{
+    return overflows.load(std::memory_order_relaxed);
+}
+
+const char *chart_channel_name(uint8_t ch)
+{
+    switch (ch)
+    {
+    case CHART_ANG_TAR: return "ang_tar";
+    case CHART_PITCH: return "pitch";
+    case CHART_SPD_TAR: return "spd_tar";
+    case CHART_SPD_NOW: return "spd_now";
+    case CHART_TORQUE_L: return "torque_l";
+    case CHART_TORQUE_R: return "torque_r";
+    case CHART_SPEED_L: return "speed_l";
+    case CHART_SPEED_R: return "speed_r";
+    case CHART_GYRO_Y: return "gyro_y";
+    case CHART_ROLL: return "roll";
+    case CHART_YAW: return "yaw";
+    case CHART_ACC_Y: return "acc_y";
+    case CHART_DZ_L: return "dzL";
+    case CHART_DZ_R: return "dzR";
+    case CHART_BATT_V: return "voltage";
+    default: return "unknown";
+    }
+}
+// 说明：控制周期全速率曲线采集环（SPSC），供网络任务成批按列打包下发与遥测订阅聚合
@@ -0,0 +1,193 @@
+#include <atomic>
+#include "my_cmd.h"
+#include "my_control.h"
+#include "my_hal.h"
+#include "my_prof.h"
+#include "my_seqlock.h"
+
+static_assert((CMD_QUEUE_LEN & (CMD_QUEUE_LEN - 1)) == 0, "CMD_QUEUE_LEN must be a power of two");
+
+namespace
+{
+struct joy_cmd
+{
+    float x, y;
+    uint32_t t_us;
+};
+
+// 单生产者单消费者环形队列：head 只由生产者写，tail 只由消费者写
+motion_cmd ring[CMD_QUEUE_LEN];
+std::atomic<uint32_t> head{0};
+std::atomic<uint32_t> tail{0};
+std::atomic<uint32_t> dropped{0};
+
+seqlock<joy_cmd> joy_slot;
+uint32_t joy_seen = 0; // 以下仅控制任务访问
+uint8_t hw_requests = 0;
+uint32_t applied = 0;
+
+void record_latency(uint32_t t_us)
+{
+    prof_add(ProfStage::Cmd, (hal_micros() - t_us) * hal_cycles_per_us());
+}
+
+void apply(robot_state &robot, const motion_cmd &c)
+{
+    switch (c.type)
+    {
+    case CmdType::Run:
+        robot.run = c.flag;
+        break;
+    case CmdType::FallCheck:
+        robot.fallen.enable = c.flag;
+        break;
+    case CmdType::OffgroundProtect:
+        robot.offground_protect = c.flag;
+        break;
+    case CmdType::EStop:
+        robot.estop = c.flag;
+        break;
+    case CmdType::CalibImu:
+        robot.imu_recalib_req = true;
+        break;
+    case CmdType::CalibDeadzone:
+        robot.run = false;
+        robot.recalib_req = true;
+        break;
+    case CmdType::SetPid:
+        robot.ang_pid.p = c.pid.ang_p;
+        robot.ang_pid.i = c.pid.ang_i;
+        robot.ang_pid.d = c.pid.ang_d;
+        robot.spd_pid.p = c.pid.spd_p;
+        robot.spd_pid.i = c.pid.spd_i;
+        robot.spd_pid.d = c.pid.spd_d;
+        robot.yaw_pid.p = c.pid.yaw_p;
+        robot.yaw_pid.i = c.pid.yaw_i;
+        robot.yaw_pid.d = c.pid.yaw_d;
+        break;
+    case CmdType::PitchZero:
+        robot.pitch_zero = c.value;
+        break;
+    case CmdType::TorqueLimit:
+        torque_limit = c.value;
+        break;
+    case CmdType::TestMode:
+        robot.test_cmd = c.flag;
+        if (!c.flag)
+            control_reset(robot);
+        break;
+    case CmdType::MotorMode:
+        robot.motor_mode = c.mode;
+        break;
+    case CmdType::MotorOut:
+        if (robot.test_cmd)
+        {
+            robot.tor.L = c.out.l;
+            robot.tor.R = c.out.r;
+        }
+        break;
+    case CmdType::RestartImu:
+        hw_requests |= CMD_HW_RESTART_IMU;
+        break;
+    case CmdType::RestartMotor:
+        hw_requests |= CMD_HW_RESTART_MOTOR;
+        break;
+    case CmdType::RealignMotor:
+        hw_requests |= CMD_HW_REALIGN_MOTOR;
+        break;
+    }
+}
+} // namespace
+
+bool cmd_post(motion_cmd c)
+{
+    const uint32_t h = head.load(std::memory_order_relaxed);
+    if (h - tail.load(std::memory_order_acquire) >= CMD_QUEUE_LEN)
+    {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    c.t_us = hal_micros();
+    ring[h & (CMD_QUEUE_LEN - 1)] = c;
+    head.store(h + 1, std::memory_order_release);
+    return true;
+}
+
+bool cmd_post_flag(CmdType type, bool flag)
+{
+    motion_cmd c{};
+    c.type = type;
+    c.flag = flag;
+    return cmd_post(c);
+}
+
+bool cmd_post_value(CmdType type, float value)
+{
+    motion_cmd c{};
+    c.type = type;
+    c.value = value;
+    return cmd_post(c);
+}
+
+void cmd_post_joy(float x, float y)
+{
+    joy_slot.store(joy_cmd{x, y, hal_micros()});
+}
+
+cmd_pid cmd_pid_from(const robot_state &robot)
+{
+    return cmd_pid{
+        robot.ang_pid.p, robot.ang_pid.i, robot.ang_pid.d,
+        robot.spd_pid.p, robot.spd_pid.i, robot.spd_pid.d,
+        robot.yaw_pid.p, robot.yaw_pid.i, robot.yaw_pid.d,
+    };
+}
+
+int cmd_drain(robot_state &robot)
+{
+    int n = 0;
+    // 只处理进入时已在队列中的指令，单周期工作量有上限
+    const uint32_t h = head.load(std::memory_order_acquire);
+    uint32_t t = tail.load(std::memory_order_relaxed);
+    for (; t != h; ++t, ++n)
+    {
+        const motion_cmd &c = ring[t & (CMD_QUEUE_LEN - 1)];
+        apply(robot, c);
+        record_latency(c.t_us);
+    }
+    tail.store(t, std::memory_order_release);
+
+    // 摇杆只取最新值；同核高优先级读者用 try_load，写到一半就留到下个周期
+    const uint32_t v = joy_slot.version();
+    joy_cmd j;
+    if (v != joy_seen && joy_slot.try_load(j))
+    {
+        joy_seen = v;
+        robot.joy.x = j.x;
+        robot.joy.y = j.y;
+        robot.joy_stop_control = false;
+        record_latency(j.t_us);
+        ++n;
+    }
+
+    applied += n;
+    return n;
+}
+
+uint8_t cmd_take_hw_requests()
+{
+    const uint8_t r = hw_requests;
+    hw_requests = 0;
+    return r;
+}
+
+uint32_t cmd_applied()
+{
+    return applied;
+}
+
+uint32_t cmd_dropped()
+{
+    return dropped.load(std::memory_order_relaxed);
+}
+// 说明：网络指令邮箱（有界 SPSC 队列 + 摇杆最新值槽），由控制任务在运动更新开头统一生效并统计延迟
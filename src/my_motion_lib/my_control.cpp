@@ -3,6 +3,7 @@
 #include <SimpleFOC.h>
 #include "my_control.h"
 #include "my_tool.h"
+#include "my_hal.h"
 
 // PID 控制器（速度环/转向环仍用 SimpleFOC PID）
 static PIDController PID_SPD{0, 0, 0, 0, 0};
@@ -11,7 +12,6 @@ static PIDController PID_YAW{0, 0, 0, 0, 0};
 // 角度环：手写 P+I，支持 back-calculation 抗饱和
 static float ang_integral   = 0.0f;
 static float ang_err_prev   = 0.0f;
-static uint32_t ang_ts_prev = 0;
 
 // 陀螺阻尼低通滤波状态
 static float filtered_gyroy  = 0.0f;
@@ -21,6 +21,8 @@ static float spd_tar_prev = 0.0f;
 
 // 运行时可调的力矩总幅限制
 float torque_limit = TOR_SUM_LIM;
+float gravity_ff_gain = GRAVITY_FF_GAIN;
+float accel_ff_gain = ACCEL_FF_GAIN;
 static uint32_t soft_takeover_start = 0;
 static bool soft_takeover = false;
 
@@ -46,7 +48,6 @@ void control_reset(robot_state &robot)
     // 角度环手写状态复位
     ang_integral  = 0.0f;
     ang_err_prev  = 0.0f;
-    ang_ts_prev   = 0;
     filtered_gyroy = 0.0f;
     spd_tar_prev  = 0.0f;
 
@@ -73,11 +74,11 @@ void control_pitch(robot_state &robot)
     pitch_delta = my_lim(pitch_delta, PITCH_TAR_MAX_DEG);
 
     // 速度指令前馈：摇杆变化率直接前馈到倾角，提升操控响应
-    const uint32_t now_us = micros();
-    float dt = (ang_ts_prev == 0) ? 0.002f : (now_us - ang_ts_prev) * 1e-6f;
-    if (dt <= 0.0f || dt > 0.1f) dt = 0.002f;
+    // dt 取调度给出的本周期间隔，与周期设置无关
+    float dt = robot.dt;
+    if (dt <= 0.0f || dt > 0.1f) dt = robot.dt_us * 1e-6f;
     const float spd_tar_rate = (robot.spd.tar - spd_tar_prev) / dt;
-    pitch_delta += ACCEL_FF_GAIN * spd_tar_rate;
+    pitch_delta += accel_ff_gain * spd_tar_rate;
     pitch_delta = my_lim(pitch_delta, PITCH_TAR_MAX_DEG);
     spd_tar_prev = robot.spd.tar;
 
@@ -92,7 +93,6 @@ void control_pitch(robot_state &robot)
     // I 项（梯形积分）
     ang_integral += robot.ang_pid.i * dt * 0.5f * (robot.ang.err + ang_err_prev);
     ang_err_prev = robot.ang.err;
-    ang_ts_prev  = now_us;
 
     float pid_out = p_term + ang_integral;
 
@@ -103,7 +103,7 @@ void control_pitch(robot_state &robot)
 
     // 重力前馈
     const float lean_rad = (robot.ang.now - robot.pitch_zero) * (PI / 180.0f);
-    const float gravity_ff = -GRAVITY_FF_GAIN * sinf(lean_rad);
+    const float gravity_ff = -gravity_ff_gain * sinf(lean_rad);
 
     float tor = pid_out - gyro_damping + gravity_ff;
 
@@ -163,8 +163,8 @@ void control_swing_up(robot_state &robot)
 {
     static uint32_t swing_start = 0;
     if (swing_start == 0)
-        swing_start = millis();
-    const float t = (millis() - swing_start) / 1000.0f;
+        swing_start = hal_millis();
+    const float t = (hal_millis() - swing_start) / 1000.0f;
     const float omega = 2.0f * PI * SWING_FREQ_HZ;
     float amp = SWING_MAX_TORQUE;
     // 随时间略微收敛
@@ -178,7 +178,7 @@ void control_swing_up(robot_state &robot)
     if (fabsf(robot.ang.now) < SWING_EXIT_PITCH_DEG)
     {
         soft_takeover = true;
-        soft_takeover_start = millis();
+        soft_takeover_start = hal_millis();
         swing_start = 0;
     }
 }
@@ -187,7 +187,7 @@ bool control_soft_takeover_active()
 {
     if (!soft_takeover)
         return false;
-    if (millis() - soft_takeover_start > SOFT_TAKEOVER_MS)
+    if (hal_millis() - soft_takeover_start > SOFT_TAKEOVER_MS)
     {
         soft_takeover = false;
         return false;
@@ -199,7 +199,7 @@ float control_soft_takeover_gain()
 {
     if (!soft_takeover)
         return 1.0f;
-    float k = (millis() - soft_takeover_start) / float(SOFT_TAKEOVER_MS);
+    float k = (hal_millis() - soft_takeover_start) / float(SOFT_TAKEOVER_MS);
     if (k >= 1.0f)
     {
         soft_takeover = false;
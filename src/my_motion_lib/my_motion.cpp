@@ -6,12 +6,17 @@
 #include "my_control.h"
 #include "my_calibration.h"
 #include "my_storage.h"
-#include "my_foc.h"
+#include "my_warm.h"
+#include "my_hal.h"
 #include "my_bat.h"
+#include "my_seqlock.h"
+#include "my_cmd.h"
+#include "my_chart.h"
 
 // 全局机器人状态
 robot_state robot = {
-    .dt_ms = 2,
+    .dt_us = CONTROL_PERIOD_US,
+    .dt = CONTROL_PERIOD_US * 1e-6f,
     .data_ms = 100,
     .run = false,
     .test_cmd = false,
@@ -48,6 +53,42 @@ robot_state robot = {
 };
 
 static MotionState prev_state = MotionState::Init;
+static seqlock<robot_frame> frame_slot;
+static uint32_t frame_seq = 0;
+
+// 本周期结果打包发布，控制路径只做一次定长拷贝
+static void publish_frame()
+{
+    robot_frame f;
+    f.seq = ++frame_seq;
+    f.t_ms = hal_millis();
+    f.dt_us = robot.dt_us;
+    f.state = robot.state;
+    f.fallen = robot.fallen.is;
+    f.wel_up = robot.wel_up;
+    f.drv_fault = robot.drv_fault;
+    f.lowbat_warn = robot.lowbat_warn;
+    f.pitch = robot.ang.now;
+    f.roll = robot.imu.anglex;
+    f.yaw = robot.yaw.now;
+    f.pitch_raw = robot.imu.angley;
+    f.pitch_zero = robot.pitch_zero;
+    f.gyro_y = robot.imu.gyroy;
+    f.ang_tar = robot.ang.tar;
+    f.spd_tar = robot.spd.tar;
+    f.spd_now = robot.spd.now;
+    f.wL = robot.wL;
+    f.wR = robot.wR;
+    f.tor_base = robot.tor.base;
+    f.tor_L = robot.tor.L;
+    f.tor_R = robot.tor.R;
+    f.dzL = robot.tor.dzL;
+    f.dzR = robot.tor.dzR;
+    f.torque_limit = torque_limit;
+    f.batt_v = battery_voltage;
+    frame_slot.store(f);
+    chart_push(f);
+}
 
 // 汇总状态机输入
 static MotionInputs collect_motion_inputs()
@@ -97,27 +138,39 @@ void my_motion_init()
         robot.gyro_run = robot.gyro_base;
     }
 
+    // 加载整定参数；未保存过的沿用编译期默认值
+    cmd_pid pid;
+    if (storage_load_pid(pid))
+    {
+        robot.ang_pid.p = pid.ang_p;
+        robot.ang_pid.i = pid.ang_i;
+        robot.ang_pid.d = pid.ang_d;
+        robot.spd_pid.p = pid.spd_p;
+        robot.spd_pid.i = pid.spd_i;
+        robot.spd_pid.d = pid.spd_d;
+        robot.yaw_pid.p = pid.yaw_p;
+        robot.yaw_pid.i = pid.yaw_i;
+        robot.yaw_pid.d = pid.yaw_d;
+    }
+    storage_load_torque_limit(torque_limit);
+    storage_load_pitch_zero(robot.pitch_zero);
+
+    // 软件复位后沿用上次运行已收敛的姿态、零偏、死区与零点（比存档更新）
+    warm_restore(robot);
+
     prev_state = MotionState::Init;
 }
 
-void my_motion_update()
+static void motion_step(const hal_sense_snapshot &snap)
 {
     // 传感与估计
-    sense_update_wheel_speeds(robot);
+    sense_update_wheel_speeds(robot, snap);
     robot.imu_l = robot.imu; // 备份上一帧 IMU（外部更新已有）
     sense_update_attitude(robot);
     sense_update_gyro_bias(robot);
 
-    // I2C 存活检测降频：避免每 2ms 做 3 次 I2C ping 引入控制环抖动
-    {
-        static uint32_t last_i2c_check = 0;
-        const uint32_t now = millis();
-        if (now - last_i2c_check >= I2C_FAULT_CHECK_MS)
-        {
-            last_i2c_check = now;
-            sense_check_i2c_fault(robot);
-        }
-    }
+    // I2C 存活检测由采集端按 I2C_FAULT_CHECK_MS 降频执行，这里只取结果
+    sense_check_i2c_fault(robot, snap);
 
     sense_adapt_pitch_zero(robot);
     sense_wel_up_detect(robot);
@@ -136,7 +189,7 @@ void my_motion_update()
 
     // 状态机
     MotionInputs inputs = collect_motion_inputs();
-    MotionDecision decision = motion_state_step(robot.state, inputs, millis());
+    MotionDecision decision = motion_state_step(robot.state, inputs, hal_millis());
     robot.state = decision.state;
     robot.lowbat_warn = decision.lowbat_warn;
 
@@ -183,4 +236,59 @@ void my_motion_update()
 
     prev_state = robot.state;
 }
-// 说明：协调传感、状态机、标定挂钩与控制环集成
+
+void my_motion_update(const hal_sense_snapshot &snap)
+{
+    // 网络指令只在这里生效，本周期后续逻辑看到的是一致的输入
+    cmd_drain(robot);
+    motion_step(snap);
+    publish_frame();
+    warm_save(robot);
+}
+
+bool my_motion_snapshot(robot_frame &out)
+{
+    if (frame_slot.version() == 0)
+        return false;
+    out = frame_slot.load();
+    return true;
+}
+
+// 根据实时电池电压调整驱动供电参数，避免电量高低导致力感变化
+static inline float update_supply_from_battery()
+{
+    // 未初始化时用满电作为兜底
+    const float supply = (battery_voltage > 1.0f) ? battery_voltage : BAT_FULL_VOLTAGE;
+    // 将输出上限跟随供电，预留 15% 余量防止触顶
+    const float limit = supply * 0.85f;
+    hal_motor_set_supply(supply, limit);
+    return limit;
+}
+
+void my_motor_update()
+{
+    const float limit = update_supply_from_battery();
+
+    if (robot.state == MotionState::Test)
+    {
+        switch (robot.motor_mode)
+        {
+        case MODE_SPEED:
+            hal_motor_output(HalMotorLoop::Velocity, robot.tor.L, robot.tor.R);
+            break;
+        case MODE_POS:
+            hal_motor_output(HalMotorLoop::Angle, robot.tor.L * (PI / 180.0f), robot.tor.R * (PI / 180.0f));
+            break;
+        case MODE_PWM:
+        default:
+            // Map -1000~1000 to -Limit~Limit
+            hal_motor_output(HalMotorLoop::Torque, (robot.tor.L / 1000.0f) * limit, (robot.tor.R / 1000.0f) * limit);
+            break;
+        }
+    }
+    else
+    {
+        hal_motor_output(HalMotorLoop::Torque, robot.tor.L, robot.tor.R);
+    }
+}
+// 说明：协调传感、状态机、标定挂钩与控制环集成，并将力矩映射为电机输出
@@ -1,19 +1,15 @@
-#include <Arduino.h>
 #include <cmath>
 #include "my_sense.h"
-#include "my_foc.h"
 #include "my_config.h"
 #include "my_storage.h"
-#include "my_mpu6050.h"
-#include "my_i2c.h"
+#include "my_warm.h"
+#include "my_hal.h"
 
-// 单次刷新左右轮角速度并缓存
-void sense_update_wheel_speeds(robot_state &robot)
+// 从快照取左右轮角速度并缓存
+void sense_update_wheel_speeds(robot_state &robot, const hal_sense_snapshot &snap)
 {
-    sensor_1.update();
-    sensor_2.update();
-    robot.wL = sensor_1.getVelocity();
-    robot.wR = sensor_2.getVelocity();
+    robot.wL = snap.wL;
+    robot.wR = snap.wR;
 }
 
 // 更新姿态/航向/速度估计
@@ -48,7 +44,7 @@ void sense_wel_up_detect(robot_state &robot)
 
     static uint32_t off_enter_ms = 0;
     static uint32_t off_exit_ms = 0;
-    const uint32_t now = millis();
+    const uint32_t now = hal_millis();
 
     if (!robot.wel_up && high_w && torque_enough && pitch_abs < 6.0f)
     {
@@ -105,7 +101,7 @@ bool sense_fallen_recover_ready(robot_state &robot)
     static uint32_t fallen_rec_ms = 0;
     const float pitch_abs = fabsf(robot.ang.now);
     const float gyroY_abs = fabsf(robot.imu.gyroy);
-    const uint32_t now = millis();
+    const uint32_t now = hal_millis();
 
     if (pitch_abs < FALLEN_REC_PITCH_DEG && gyroY_abs < FALLEN_REC_GYRO_DPS)
     {
@@ -130,37 +126,20 @@ bool sense_no_op(const robot_state &robot)
 // ------------- 陀螺零偏微校准 -------------
 void sense_update_gyro_bias(robot_state &robot)
 {
-    static bool base_loaded = false;
-    static bool base_calibrated = false;
-    static uint32_t boot_ms = millis();
+    static uint32_t boot_ms = hal_millis();
     static uint32_t accum_start = 0;
     static float acc_gx = 0, acc_gy = 0, acc_gz = 0;
     static uint16_t acc_cnt = 0;
 
-    // 首次加载持久化基准
-    if (!base_loaded)
-    {
-        float gx = robot.gyro_base.gx, gy = robot.gyro_base.gy, gz = robot.gyro_base.gz;
-        base_calibrated = storage_load_gyro_bias(gx, gy, gz);
-        if (base_calibrated)
-        {
-            robot.gyro_base = {gx, gy, gz};
-            robot.gyro_run = robot.gyro_base;
-        }
-        base_loaded = true;
-        boot_ms = millis();
-        accum_start = 0;
-        acc_cnt = 0;
-        acc_gx = acc_gy = acc_gz = 0;
-    }
+    // 持久化基准已在 my_motion_init 中载入 gyro_base / gyro_run
 
     // 条件：静止且姿态平稳
     const bool quiet = (fabsf(robot.ang.now) < 8.0f) && (fabsf(robot.imu.gyroy) < 20.0f) && sense_no_op(robot);
-    const uint32_t now = millis();
+    const uint32_t now = hal_millis();
 
     bool want_calib = false;
-    // 1) 上电后 1s 内自动微校准
-    if (now - boot_ms < 1000U)
+    // 1) 上电后 1s 内自动微校准（热启动已沿用上次的运行零偏）
+    if (!warm_booted() && now - boot_ms < 1000U)
         want_calib = true;
     // 2) 外部请求 IMU 重新校准
     if (robot.imu_recalib_req)
@@ -210,32 +189,23 @@ void sense_update_gyro_bias(robot_state &robot)
 // 静止自适应 pitch 零点：缓慢逼近当前姿态
 void sense_adapt_pitch_zero(robot_state &robot)
 {
-    static uint32_t boot_ms = millis();
+    static uint32_t boot_ms = hal_millis();
     const bool quiet = (fabsf(robot.ang.now) < ZERO_ADAPT_DEADBAND_DEG) &&
                        (fabsf(robot.imu.gyroy) < ZERO_ADAPT_GYRO_DPS) &&
                        sense_no_op(robot);
     if (!quiet)
         return;
     const float err = robot.ang.now - robot.pitch_zero;
-    const uint32_t now = millis();
-    const bool fast_stage = (now - boot_ms) < ZERO_ADAPT_FAST_MS;
+    const uint32_t now = hal_millis();
+    const bool fast_stage = !warm_booted() && (now - boot_ms) < ZERO_ADAPT_FAST_MS;
     const float adapt_rate = fast_stage ? ZERO_ADAPT_FAST_RATE : ZERO_ADAPT_RATE;
     robot.pitch_zero += err * adapt_rate;
 }
 
-// I2C 设备应答检测：MPU6050 与左右 AS5600（两路总线）
-bool sense_check_i2c_fault(robot_state &robot)
+// I2C 设备应答检测结果：MPU6050 与左右 AS5600（两路总线）
+bool sense_check_i2c_fault(robot_state &robot, const hal_sense_snapshot &snap)
 {
-    auto ping = [](TwoWire &w, uint8_t addr) {
-        w.beginTransmission(addr);
-        return w.endTransmission() == 0;
-    };
-
-    bool ok_mpu = ping(Wire0, ADDR_MPU6050);
-    bool ok_as_l = ping(Wire0, ADDR_AS5600);
-    bool ok_as_r = ping(Wire1, ADDR_AS5600);
-
-    robot.drv_fault = !(ok_mpu && ok_as_l && ok_as_r);
+    robot.drv_fault = !snap.alive;
     return robot.drv_fault;
 }
 // 说明：传感融合与状态检测（轮速、姿态、陀螺零偏、摔倒/离地）
@@ -1,21 +1,78 @@
 #include <Arduino.h>
 #include "my_storage.h"
+#include "my_config.h"
+#include "my_tool.h"
 #include <Preferences.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
 
 namespace
 {
 constexpr const char *NVS_NAMESPACE = "balbot";
-constexpr const char *NVS_KEY_CALOK = "cal_ok";
-constexpr const char *NVS_KEY_DZL = "dzL";
-constexpr const char *NVS_KEY_DZR = "dzR";
-constexpr const char *NVS_KEY_GOK = "g_ok";
-constexpr const char *NVS_KEY_GX = "gx";
-constexpr const char *NVS_KEY_GY = "gy";
-constexpr const char *NVS_KEY_GZ = "gz";
+constexpr const char *NVS_KEY_SETTINGS = "cfg";
+constexpr uint32_t STORAGE_MAGIC = 0x47464342; // "BCFG"
+constexpr size_t BLOB_MAX = 1024;              // 读入上限，容纳后续版本追加的字段
+
+// 旧版逐键存储，仅用于迁移；迁移结果首次落盘成功后删除
+constexpr const char *LEGACY_CALOK = "cal_ok";
+constexpr const char *LEGACY_DZL = "dzL";
+constexpr const char *LEGACY_DZR = "dzR";
+constexpr const char *LEGACY_GOK = "g_ok";
+constexpr const char *LEGACY_GX = "gx";
+constexpr const char *LEGACY_GY = "gy";
+constexpr const char *LEGACY_GZ = "gz";
+constexpr const char *LEGACY_FOC_OK[2] = {"fa_ok0", "fa_ok1"};
+constexpr const char *LEGACY_FOC_ZERO[2] = {"fa_z0", "fa_z1"};
+constexpr const char *LEGACY_FOC_DIR[2] = {"fa_d0", "fa_d1"};
+constexpr const char *LEGACY_WS_PASSWORD = "ws_pwd";
+constexpr const char *LEGACY_ROBOT_NAME = "robot_name";
+constexpr const char *LEGACY_WIFI_SSID = "wifi_ssid";
+constexpr const char *LEGACY_WIFI_PASS = "wifi_pass";
+constexpr const char *LEGACY_PITCH_ZERO = "pitch_zero";
+constexpr const char *LEGACY_KEYS[] = {
+    LEGACY_CALOK, LEGACY_DZL, LEGACY_DZR, LEGACY_GOK, LEGACY_GX, LEGACY_GY, LEGACY_GZ,
+    LEGACY_FOC_OK[0], LEGACY_FOC_ZERO[0], LEGACY_FOC_DIR[0],
+    LEGACY_FOC_OK[1], LEGACY_FOC_ZERO[1], LEGACY_FOC_DIR[1],
+    LEGACY_WS_PASSWORD, LEGACY_ROBOT_NAME, LEGACY_WIFI_SSID, LEGACY_WIFI_PASS, LEGACY_PITCH_ZERO,
+};
+
+// 落盘格式：头 + storage_settings。crc 覆盖头（crc 字段记 0）与 size 字节负载
+struct storage_header
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t size;
+    uint32_t crc;
+};
+
+struct storage_blob
+{
+    storage_header h;
+    storage_settings s;
+};
+static_assert(sizeof(storage_blob) <= BLOB_MAX, "storage_settings outgrew BLOB_MAX");
 
 Preferences prefs;
 bool ready = false;
 
+// 内存副本：启动时读入一次，读写都在临界区内整体拷贝
+storage_settings cur{};
+bool dirty = false;
+bool legacy_pending = false; // 旧键待删除
+StorageOrigin origin = StorageOrigin::Empty;
+uint32_t load_us = 0;
+portMUX_TYPE mux = portMUX_INITIALIZER_UNLOCKED;
+TaskHandle_t task = nullptr;
+SemaphoreHandle_t commit_lock = nullptr;
+
+// 以下持有 commit_lock 时写
+uint32_t commits = 0;
+uint32_t bytes_written = 0;
+uint32_t failures = 0;
+uint32_t last_commit_us = 0;
+uint32_t max_commit_us = 0;
+
 bool ensure_ready()
 {
     if (ready)
@@ -23,84 +80,468 @@ bool ensure_ready()
     ready = prefs.begin(NVS_NAMESPACE, false);
     return ready;
 }
+
+uint32_t blob_crc(storage_header h, const uint8_t *payload)
+{
+    h.crc = 0;
+    return my_crc32(payload, h.size, my_crc32(&h, sizeof(h)));
+}
+
+void seal(storage_blob &b)
+{
+    b.h.magic = STORAGE_MAGIC;
+    b.h.version = STORAGE_VERSION;
+    b.h.size = sizeof(storage_settings);
+    b.h.crc = blob_crc(b.h, reinterpret_cast<const uint8_t *>(&b.s));
+}
+
+template <size_t N>
+void terminate(char (&text)[N])
+{
+    text[N - 1] = '\0';
+}
+
+// 校验并解出；版本不同（含更新的固件写下的 blob）都按共同前缀拷贝
+bool unpack(const uint8_t *raw, size_t len, storage_settings &out)
+{
+    storage_header h;
+    if (len < sizeof(h))
+        return false;
+    memcpy(&h, raw, sizeof(h));
+    if (h.magic != STORAGE_MAGIC || sizeof(h) + h.size > len)
+        return false;
+    if (blob_crc(h, raw + sizeof(h)) != h.crc)
+        return false;
+    out = storage_settings{};
+    memcpy(&out, raw + sizeof(h), std::min<size_t>(h.size, sizeof(out)));
+    terminate(out.ws_password);
+    terminate(out.robot_name);
+    terminate(out.wifi_ssid);
+    terminate(out.wifi_pass);
+    return true;
+}
+
+bool read_blob(storage_settings &out)
+{
+    const size_t len = prefs.getBytesLength(NVS_KEY_SETTINGS);
+    if (len == 0 || len > BLOB_MAX)
+        return false;
+    std::vector<uint8_t> raw(len);
+    return prefs.getBytes(NVS_KEY_SETTINGS, raw.data(), len) == len && unpack(raw.data(), len, out);
+}
+
+template <size_t N>
+void legacy_text(const char *key, char (&out)[N])
+{
+    const String v = prefs.getString(key, "");
+    strncpy(out, v.c_str(), N - 1);
+    out[N - 1] = '\0';
+}
+
+// 旧版逐键存储 → storage_settings，没有任何旧键返回 false
+bool migrate_legacy(storage_settings &s)
+{
+    bool found = false;
+    for (const char *key : LEGACY_KEYS)
+        found |= prefs.isKey(key);
+    if (!found)
+        return false;
+
+    if (prefs.getBool(LEGACY_CALOK, false))
+    {
+        s.dzL = prefs.getFloat(LEGACY_DZL, 0.0f);
+        s.dzR = prefs.getFloat(LEGACY_DZR, 0.0f);
+        s.present |= STORAGE_CALIB;
+    }
+    if (prefs.getBool(LEGACY_GOK, false))
+    {
+        s.gx = prefs.getFloat(LEGACY_GX, 0.0f);
+        s.gy = prefs.getFloat(LEGACY_GY, 0.0f);
+        s.gz = prefs.getFloat(LEGACY_GZ, 0.0f);
+        s.present |= STORAGE_GYRO;
+    }
+    for (uint8_t m = 0; m < 2; ++m)
+    {
+        if (!prefs.getBool(LEGACY_FOC_OK[m], false))
+            continue;
+        s.foc_zero[m] = prefs.getFloat(LEGACY_FOC_ZERO[m], 0.0f);
+        s.foc_dir[m] = prefs.getChar(LEGACY_FOC_DIR[m], 0);
+        s.present |= m == 0 ? STORAGE_FOC_L : STORAGE_FOC_R;
+    }
+    if (prefs.isKey(LEGACY_WS_PASSWORD))
+    {
+        legacy_text(LEGACY_WS_PASSWORD, s.ws_password);
+        s.present |= STORAGE_WS_PASSWORD;
+    }
+    if (prefs.isKey(LEGACY_ROBOT_NAME))
+    {
+        legacy_text(LEGACY_ROBOT_NAME, s.robot_name);
+        s.present |= STORAGE_ROBOT_NAME;
+    }
+    if (prefs.isKey(LEGACY_WIFI_SSID))
+    {
+        legacy_text(LEGACY_WIFI_SSID, s.wifi_ssid);
+        legacy_text(LEGACY_WIFI_PASS, s.wifi_pass);
+        s.present |= STORAGE_WIFI;
+    }
+    // 旧版以 0 表示未设置
+    const float pz = prefs.getFloat(LEGACY_PITCH_ZERO, 0.0f);
+    if (pz != 0.0f)
+    {
+        s.pitch_zero = pz;
+        s.present |= STORAGE_PITCH_ZERO;
+    }
+    return true;
+}
+
+void load()
+{
+    const uint32_t t0 = micros();
+    storage_settings s{};
+    if (read_blob(s))
+    {
+        origin = StorageOrigin::Blob;
+    }
+    else
+    {
+        const bool corrupt = prefs.isKey(NVS_KEY_SETTINGS);
+        s = storage_settings{};
+        legacy_pending = migrate_legacy(s);
+        origin = legacy_pending ? StorageOrigin::Legacy : corrupt ? StorageOrigin::Corrupt : StorageOrigin::Empty;
+        // 写下一份有效 blob，之后启动只需读一个键
+        dirty = true;
+    }
+    cur = s;
+    load_us = micros() - t0;
+}
+
+storage_settings snapshot()
+{
+    portENTER_CRITICAL(&mux);
+    const storage_settings s = cur;
+    portEXIT_CRITICAL(&mux);
+    return s;
+}
+
+// 在副本上修改；值未变时什么都不做。任何任务（含控制任务）均可调用，不阻塞
+template <typename Edit>
+void stage(Edit edit)
+{
+    portENTER_CRITICAL(&mux);
+    storage_settings next = cur;
+    edit(next);
+    const bool changed = memcmp(&next, &cur, sizeof(cur)) != 0;
+    if (changed)
+    {
+        cur = next;
+        dirty = true;
+    }
+    portEXIT_CRITICAL(&mux);
+    if (changed && task)
+        xTaskNotifyGive(task);
+}
+
+// 整份 blob 一次写入单个键；调用方持有 commit_lock
+void commit()
+{
+    static storage_blob blob;
+    portENTER_CRITICAL(&mux);
+    const bool todo = dirty;
+    blob.s = cur;
+    dirty = false;
+    portEXIT_CRITICAL(&mux);
+    if (!todo || !ensure_ready())
+        return;
+
+    seal(blob);
+    const uint32_t t0 = micros();
+    if (prefs.putBytes(NVS_KEY_SETTINGS, &blob, sizeof(blob)) != sizeof(blob))
+    {
+        failures++;
+        portENTER_CRITICAL(&mux);
+        dirty = true;
+        portEXIT_CRITICAL(&mux);
+        return;
+    }
+    if (legacy_pending)
+    {
+        for (const char *key : LEGACY_KEYS)
+            prefs.remove(key);
+        legacy_pending = false;
+    }
+    last_commit_us = micros() - t0;
+    if (last_commit_us > max_commit_us)
+        max_commit_us = last_commit_us;
+    commits++;
+    bytes_written += sizeof(blob);
+}
+
+// 持久化任务：收到写入后等 STORAGE_COALESCE_MS 无新写入再合并提交，
+// 两次提交至少间隔 STORAGE_MIN_INTERVAL_MS，连续调参也不会频繁擦写 flash
+void storage_task(void *)
+{
+    TickType_t last = 0;
+    for (;;)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        while (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(STORAGE_COALESCE_MS)) > 0)
+        {
+        }
+        const TickType_t since = xTaskGetTickCount() - last;
+        if (last != 0 && since < pdMS_TO_TICKS(STORAGE_MIN_INTERVAL_MS))
+            vTaskDelay(pdMS_TO_TICKS(STORAGE_MIN_INTERVAL_MS) - since);
+        xSemaphoreTake(commit_lock, portMAX_DELAY);
+        commit();
+        xSemaphoreGive(commit_lock);
+        last = xTaskGetTickCount();
+    }
+}
+
+void pid_pack(storage_settings &s, const cmd_pid &pid)
+{
+    s.pid_ang_p = pid.ang_p;
+    s.pid_ang_i = pid.ang_i;
+    s.pid_ang_d = pid.ang_d;
+    s.pid_spd_p = pid.spd_p;
+    s.pid_spd_i = pid.spd_i;
+    s.pid_spd_d = pid.spd_d;
+    s.pid_yaw_p = pid.yaw_p;
+    s.pid_yaw_i = pid.yaw_i;
+    s.pid_yaw_d = pid.yaw_d;
+}
+
+void pid_unpack(const storage_settings &s, cmd_pid &pid)
+{
+    pid.ang_p = s.pid_ang_p;
+    pid.ang_i = s.pid_ang_i;
+    pid.ang_d = s.pid_ang_d;
+    pid.spd_p = s.pid_spd_p;
+    pid.spd_i = s.pid_spd_i;
+    pid.spd_d = s.pid_spd_d;
+    pid.yaw_p = s.pid_yaw_p;
+    pid.yaw_i = s.pid_yaw_i;
+    pid.yaw_d = s.pid_yaw_d;
+}
 } // namespace
 
+void storage_start()
+{
+    if (task)
+        return;
+    if (ensure_ready())
+        load();
+    commit_lock = xSemaphoreCreateMutex();
+    xTaskCreatePinnedToCore(storage_task, "storage", 4096, nullptr, 1, &task, 1);
+    if (dirty)
+        xTaskNotifyGive(task);
+}
+
+void storage_flush()
+{
+    if (!commit_lock)
+    {
+        commit();
+        return;
+    }
+    xSemaphoreTake(commit_lock, portMAX_DELAY);
+    commit();
+    xSemaphoreGive(commit_lock);
+}
+
+const char *storage_origin_name(StorageOrigin o)
+{
+    switch (o)
+    {
+    case StorageOrigin::Empty: return "empty";
+    case StorageOrigin::Blob: return "blob";
+    case StorageOrigin::Legacy: return "legacy";
+    case StorageOrigin::Corrupt: return "corrupt";
+    default: return "unknown";
+    }
+}
+
+storage_stats storage_get_stats()
+{
+    storage_stats s;
+    s.commits = commits;
+    s.bytes_written = bytes_written;
+    s.failures = failures;
+    s.origin = origin;
+    s.load_us = load_us;
+    s.last_commit_us = last_commit_us;
+    s.max_commit_us = max_commit_us;
+    portENTER_CRITICAL(&mux);
+    s.pending = dirty;
+    portEXIT_CRITICAL(&mux);
+    return s;
+}
+
 bool storage_load_calib(float &dzL, float &dzR)
 {
-    if (!ensure_ready())
-        return false;
-    const bool ok = prefs.getBool(NVS_KEY_CALOK, false);
-    if (!ok)
+    const storage_settings s = snapshot();
+    if (!(s.present & STORAGE_CALIB))
         return false;
-    dzL = prefs.getFloat(NVS_KEY_DZL, dzL);
-    dzR = prefs.getFloat(NVS_KEY_DZR, dzR);
+    dzL = s.dzL;
+    dzR = s.dzR;
     return true;
 }
 
 void storage_save_calib(float dzL, float dzR)
 {
-    if (!ensure_ready())
-        return;
-    prefs.putBool(NVS_KEY_CALOK, true);
-    prefs.putFloat(NVS_KEY_DZL, dzL);
-    prefs.putFloat(NVS_KEY_DZR, dzR);
+    stage([=](storage_settings &s) {
+        s.dzL = dzL;
+        s.dzR = dzR;
+        s.present |= STORAGE_CALIB;
+    });
 }
 
 bool storage_load_gyro_bias(float &gx, float &gy, float &gz)
 {
-    if (!ensure_ready())
-        return false;
-    const bool ok = prefs.getBool(NVS_KEY_GOK, false);
-    if (!ok)
+    const storage_settings s = snapshot();
+    if (!(s.present & STORAGE_GYRO))
         return false;
-    gx = prefs.getFloat(NVS_KEY_GX, gx);
-    gy = prefs.getFloat(NVS_KEY_GY, gy);
-    gz = prefs.getFloat(NVS_KEY_GZ, gz);
+    gx = s.gx;
+    gy = s.gy;
+    gz = s.gz;
     return true;
 }
 
 void storage_save_gyro_bias(float gx, float gy, float gz)
 {
-    if (!ensure_ready())
+    stage([=](storage_settings &s) {
+        s.gx = gx;
+        s.gy = gy;
+        s.gz = gz;
+        s.present |= STORAGE_GYRO;
+    });
+}
+
+bool storage_load_foc_align(uint8_t motor, float &zero_angle, int8_t &direction)
+{
+    const storage_settings s = snapshot();
+    if (motor > 1 || !(s.present & (motor == 0 ? STORAGE_FOC_L : STORAGE_FOC_R)))
+        return false;
+    zero_angle = s.foc_zero[motor];
+    direction = s.foc_dir[motor];
+    return true;
+}
+
+void storage_save_foc_align(uint8_t motor, float zero_angle, int8_t direction)
+{
+    if (motor > 1)
         return;
-    prefs.putBool(NVS_KEY_GOK, true);
-    prefs.putFloat(NVS_KEY_GX, gx);
-    prefs.putFloat(NVS_KEY_GY, gy);
-    prefs.putFloat(NVS_KEY_GZ, gz);
+    stage([=](storage_settings &s) {
+        s.foc_zero[motor] = zero_angle;
+        s.foc_dir[motor] = direction;
+        s.present |= motor == 0 ? STORAGE_FOC_L : STORAGE_FOC_R;
+    });
 }
 
-// 通用键值存取，便于网络配置/命名/参数保存
-bool storage_load_string(const char *key, String &out)
+void storage_clear_foc_align()
 {
-    if (!ensure_ready())
+    stage([](storage_settings &s) { s.present &= ~(STORAGE_FOC_L | STORAGE_FOC_R); });
+}
+
+bool storage_load_pid(cmd_pid &out)
+{
+    const storage_settings s = snapshot();
+    if (!(s.present & STORAGE_PID))
         return false;
-    if (!prefs.isKey(key))
+    pid_unpack(s, out);
+    return true;
+}
+
+void storage_save_pid(const cmd_pid &pid)
+{
+    stage([&](storage_settings &s) {
+        pid_pack(s, pid);
+        s.present |= STORAGE_PID;
+    });
+}
+
+bool storage_load_torque_limit(float &out)
+{
+    const storage_settings s = snapshot();
+    if (!(s.present & STORAGE_TORQUE_LIMIT))
         return false;
-    out = prefs.getString(key, "");
+    out = s.torque_limit;
     return true;
 }
 
-void storage_save_string(const char *key, const String &value)
+void storage_save_torque_limit(float value)
 {
-    if (!ensure_ready())
-        return;
-    prefs.putString(key, value);
+    stage([=](storage_settings &s) {
+        s.torque_limit = value;
+        s.present |= STORAGE_TORQUE_LIMIT;
+    });
+}
+
+bool storage_load_pitch_zero(float &out)
+{
+    const storage_settings s = snapshot();
+    if (!(s.present & STORAGE_PITCH_ZERO))
+        return false;
+    out = s.pitch_zero;
+    return true;
 }
 
-bool storage_load_float(const char *key, float &out)
+void storage_save_pitch_zero(float value)
 {
-    if (!ensure_ready())
+    stage([=](storage_settings &s) {
+        s.pitch_zero = value;
+        s.present |= STORAGE_PITCH_ZERO;
+    });
+}
+
+template <size_t N>
+void copy_text(char (&out)[N], const String &value)
+{
+    strncpy(out, value.c_str(), N - 1);
+    out[N - 1] = '\0';
+}
+
+bool storage_load_text(StorageText which, String &out)
+{
+    const storage_settings s = snapshot();
+    const bool pwd = which == StorageText::WsPassword;
+    if (!(s.present & (pwd ? STORAGE_WS_PASSWORD : STORAGE_ROBOT_NAME)))
         return false;
-    if (!prefs.isKey(key))
+    out = pwd ? s.ws_password : s.robot_name;
+    return true;
+}
+
+void storage_save_text(StorageText which, const String &value)
+{
+    stage([&](storage_settings &s) {
+        if (which == StorageText::WsPassword)
+        {
+            copy_text(s.ws_password, value);
+            s.present |= STORAGE_WS_PASSWORD;
+        }
+        else
+        {
+            copy_text(s.robot_name, value);
+            s.present |= STORAGE_ROBOT_NAME;
+        }
+    });
+}
+
+bool storage_load_wifi(String &ssid, String &pass)
+{
+    const storage_settings s = snapshot();
+    if (!(s.present & STORAGE_WIFI))
         return false;
-    out = prefs.getFloat(key, out);
+    ssid = s.wifi_ssid;
+    pass = s.wifi_pass;
     return true;
 }
 
-void storage_save_float(const char *key, float value)
+void storage_save_wifi(const String &ssid, const String &pass)
 {
-    if (!ensure_ready())
-        return;
-    prefs.putFloat(key, value);
+    stage([&](storage_settings &s) {
+        copy_text(s.wifi_ssid, ssid);
+        copy_text(s.wifi_pass, pass);
+        s.present |= STORAGE_WIFI;
+    });
 }
-// 说明：NVS 持久化封装，用于标定及通用键值存储
+// 说明：持久化配置（标定、对齐、PID、网络设置）打包为单个带版本与 CRC 的 NVS blob，启动读一次，写入由低优先级任务合并、限频后整体落盘
@@ -0,0 +1,163 @@
+#include <math.h>
+#include <stddef.h>
+#include <string.h>
+#include "my_warm.h"
+#include "my_ahrs.h"
+#include "my_calibration.h"
+#include "my_hal.h"
+#include "my_tool.h"
+
+namespace
+{
+constexpr uint32_t WARM_MAGIC = 0x4D524157; // "WARM"
+constexpr uint16_t WARM_VERSION = 1;
+
+struct warm_block
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t size;
+    uint32_t chain; // 连续热启动次数
+    ahrs_state ahrs;
+    float imu_off[3]; // MPU 驱动零偏 (deg/s)
+    float gyro_base[3];
+    float gyro_run[3];
+    float dzL, dzR;
+    float pitch_zero;
+    uint8_t calib_done;
+    uint8_t imu_off_ok;
+    uint8_t reserved[2];
+    uint32_t crc; // 覆盖之前的全部字段
+};
+static_assert(sizeof(warm_block) <= WARM_MEM_BYTES, "warm_block outgrew WARM_MEM_BYTES");
+
+// 以下仅启动流程与控制任务访问（IMU 重启也在控制任务内执行）
+warm_block live{};
+bool warm = false;
+bool imu_pending = false; // 热启动取回的 IMU 零偏尚未被驱动取走
+uint32_t boot_ms = 0;
+uint32_t last_save_ms = 0;
+
+uint32_t block_crc(const warm_block &b)
+{
+    return my_crc32(&b, offsetof(warm_block, crc));
+}
+
+bool bias_ok(const float (&g)[3])
+{
+    for (float v : g)
+        if (!isfinite(v) || fabsf(v) > WARM_GYRO_BIAS_MAX)
+            return false;
+    return true;
+}
+
+// CRC 只能证明内容是当初写入的，写入前就已发散的估计量（NaN、失控的零偏）同样会通过，
+// 因此逐项检查取值范围，任一项不合理即整体放弃
+bool values_ok(const warm_block &b)
+{
+    const ahrs_state &a = b.ahrs;
+    const float st[] = {a.q0, a.q1, a.q2, a.q3, a.eIx, a.eIy, a.eIz};
+    for (float v : st)
+        if (!isfinite(v))
+            return false;
+    const float norm2 = a.q0 * a.q0 + a.q1 * a.q1 + a.q2 * a.q2 + a.q3 * a.q3;
+    if (fabsf(norm2 - 1.0f) > 2.0f * WARM_QUAT_TOL)
+        return false;
+    if (!bias_ok(b.gyro_base) || !bias_ok(b.gyro_run) || (b.imu_off_ok && !bias_ok(b.imu_off)))
+        return false;
+    if (b.calib_done && !(b.dzL >= 0.0f && b.dzL <= WARM_DZ_MAX && b.dzR >= 0.0f && b.dzR <= WARM_DZ_MAX))
+        return false;
+    return isfinite(b.pitch_zero) && fabsf(b.pitch_zero) <= WARM_PITCH_ZERO_MAX;
+}
+
+// 复位可能发生在写入途中，读端靠 CRC 识别半截数据
+void commit()
+{
+    live.magic = WARM_MAGIC;
+    live.version = WARM_VERSION;
+    live.size = sizeof(warm_block);
+    live.crc = block_crc(live);
+    memcpy(hal_warm_mem(), &live, sizeof(live));
+}
+} // namespace
+
+bool warm_restore(robot_state &robot)
+{
+    boot_ms = hal_millis();
+    last_save_ms = boot_ms;
+    warm_block b;
+    memcpy(&b, hal_warm_mem(), sizeof(b));
+    warm = hal_warm_reset() && b.magic == WARM_MAGIC && b.version == WARM_VERSION &&
+           b.size == sizeof(warm_block) && b.crc == block_crc(b) && b.chain < WARM_MAX_CHAIN && values_ok(b);
+    if (!warm)
+    {
+        // 冷启动：作废残留内容，等第一次 warm_save 写入有效状态
+        live = warm_block{};
+        memset(hal_warm_mem(), 0, sizeof(warm_block));
+        return false;
+    }
+
+    // 先记下本次热启动，启动途中再次复位也能累计到 WARM_MAX_CHAIN
+    live = b;
+    live.chain = b.chain + 1;
+    commit();
+
+    ahrs_set_state(b.ahrs);
+    robot.gyro_base = {b.gyro_base[0], b.gyro_base[1], b.gyro_base[2]};
+    robot.gyro_run = {b.gyro_run[0], b.gyro_run[1], b.gyro_run[2]};
+    if (b.calib_done)
+        calibration_load_saved(robot, true, b.dzL, b.dzR, false);
+    robot.pitch_zero = b.pitch_zero;
+    imu_pending = b.imu_off_ok;
+    return true;
+}
+
+bool warm_booted()
+{
+    return warm;
+}
+
+void warm_save(const robot_state &robot)
+{
+    const uint32_t now = hal_millis();
+    if (now - last_save_ms < WARM_SAVE_MS)
+        return;
+    last_save_ms = now;
+    if (!ahrs_get_state(live.ahrs))
+        return;
+
+    live.gyro_base[0] = robot.gyro_base.gx;
+    live.gyro_base[1] = robot.gyro_base.gy;
+    live.gyro_base[2] = robot.gyro_base.gz;
+    live.gyro_run[0] = robot.gyro_run.gx;
+    live.gyro_run[1] = robot.gyro_run.gy;
+    live.gyro_run[2] = robot.gyro_run.gz;
+    live.calib_done = calibration_done();
+    live.dzL = robot.tor.dzL;
+    live.dzR = robot.tor.dzR;
+    live.pitch_zero = robot.pitch_zero;
+    if (live.chain != 0 && now - boot_ms >= WARM_STABLE_MS)
+        live.chain = 0;
+    commit();
+}
+
+void warm_set_imu_offsets(float gx, float gy, float gz)
+{
+    live.imu_off[0] = gx;
+    live.imu_off[1] = gy;
+    live.imu_off[2] = gz;
+    live.imu_off_ok = 1;
+    imu_pending = false;
+}
+
+bool warm_take_imu_offsets(float &gx, float &gy, float &gz)
+{
+    if (!imu_pending)
+        return false;
+    imu_pending = false;
+    gx = live.imu_off[0];
+    gy = live.imu_off[1];
+    gz = live.imu_off[2];
+    return true;
+}
+// 说明：热重启状态（姿态、零偏、死区、pitch 零点）保存在复位保留内存中，带 CRC 与连续热启动上限，软件复位后免去重新收敛
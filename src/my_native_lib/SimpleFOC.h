@@ -0,0 +1,70 @@
+#pragma once
+
+// 主机构建用的 SimpleFOC 替身：运动库只依赖 PIDController，
+// 这里按 SimpleFOC 2.3.2 的实现复刻，时间基准改为 hal_micros()
+#include "my_hal.h"
+
+class PIDController
+{
+public:
+    PIDController(float P, float I, float D, float ramp, float limit)
+        : P(P), I(I), D(D), output_ramp(ramp), limit(limit)
+    {
+        timestamp_prev = hal_micros();
+    }
+
+    float operator()(float error)
+    {
+        const uint32_t timestamp_now = hal_micros();
+        float Ts = (timestamp_now - timestamp_prev) * 1e-6f;
+        if (Ts <= 0 || Ts > 0.5f)
+            Ts = 1e-3f;
+
+        const float proportional = P * error;
+        float integral = integral_prev + I * Ts * 0.5f * (error + error_prev);
+        integral = constrain(integral, -limit, limit);
+        const float derivative = D * (error - error_prev) / Ts;
+
+        float output = proportional + integral + derivative;
+        output = constrain(output, -limit, limit);
+
+        if (output_ramp > 0)
+        {
+            const float output_rate = (output - output_prev) / Ts;
+            if (output_rate > output_ramp)
+                output = output_prev + output_ramp * Ts;
+            else if (output_rate < -output_ramp)
+                output = output_prev - output_ramp * Ts;
+        }
+
+        integral_prev = integral;
+        output_prev = output;
+        error_prev = error;
+        timestamp_prev = timestamp_now;
+        return output;
+    }
+
+    void reset()
+    {
+        integral_prev = 0.0f;
+        output_prev = 0.0f;
+        error_prev = 0.0f;
+    }
+
+    float P;
+    float I;
+    float D;
+    float output_ramp;
+    float limit;
+
+protected:
+    static float constrain(float v, float lo, float hi)
+    {
+        return (v < lo) ? lo : ((v > hi) ? hi : v);
+    }
+
+    float error_prev = 0.0f;
+    float output_prev = 0.0f;
+    float integral_prev = 0.0f;
+    uint32_t timestamp_prev = 0;
+};
@@ -0,0 +1,287 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+#include "my_motion.h"
+#include "my_ahrs.h"
+#include "my_hal_native.h"
+#include "my_sim.h"
+#include "my_sweep.h"
+#include "my_prof.h"
+#include "net_cmds.h"
+#include "my_pixfmt.h"
+
+// 主机入口：
+//   native bench [cycles]             假设备驱动下的控制周期耗时基准
+//   native sim [dt_us]                默认参数跑一次倒立摆闭环仿真，可指定控制周期
+//   native sweep [-j N] [-top K] name=lo:hi:n ...   并行网格扫描增益
+//   native dispatch [iters]           WS 指令分发耗时：哈希表 vs 逐个 strcmp
+//   native screen [iters]             屏幕图像转换耗时，并与旧的逐像素实现逐位比对
+namespace
+{
+using clock_type = std::chrono::steady_clock;
+
+double seconds_since(clock_type::time_point t0)
+{
+    return std::chrono::duration<double>(clock_type::now() - t0).count();
+}
+
+int run_bench(unsigned long cycles)
+{
+    hal_fake_reset();
+    my_motion_init();
+    robot.run = true;
+    prof_reset();
+
+    for (unsigned long i = 0; i < cycles; ++i)
+    {
+        hal_fake_advance_us(robot.dt_us);
+
+        const uint32_t t0 = prof_now();
+        hal_sense_snapshot snap;
+        hal_sense_read(snap);
+        ahrs_update(robot, snap.imu, robot.dt);
+        const uint32_t t1 = prof_now();
+        my_motion_update(snap);
+        const uint32_t t2 = prof_now();
+        my_motor_update();
+        const uint32_t t3 = prof_now();
+
+        prof_add(ProfStage::Imu, t1 - t0);
+        prof_add(ProfStage::Motion, t2 - t1);
+        prof_add(ProfStage::Motor, t3 - t2);
+        prof_cycle_end(t3 - t0, robot.dt_us);
+    }
+
+    printf("cycles=%lu dt_us=%u state=%s overruns=%u\n", cycles, robot.dt_us,
+           motion_state_name(robot.state), prof_overruns());
+    const ProfStage stages[] = {ProfStage::Imu, ProfStage::Motion, ProfStage::Motor, ProfStage::Busy};
+    for (ProfStage st : stages)
+    {
+        const prof_summary p = prof_get(st);
+        printf("%-8s avg=%7.2f us  p50<=%4.0f us  p99<=%4.0f us  max=%8.2f us\n",
+               prof_stage_name(st), p.avg_us, p.p50_us, p.p99_us, p.max_us);
+    }
+    return 0;
+}
+
+void print_result_header()
+{
+    printf("%8s %8s %8s %8s %8s %8s %8s | %5s %7s %7s %7s %7s %7s %7s %9s\n",
+           "ang_p", "ang_i", "ang_d", "spd_p", "spd_i", "grav_ff", "acc_ff",
+           "fell", "alive", "p_rms", "p_max", "drift", "v_rms", "u_rms", "cost");
+}
+
+void print_result(const sim_gains &g, const sim_result &r)
+{
+    printf("%8.4g %8.4g %8.4g %8.4g %8.4g %8.4g %8.4g | %5s %7.2f %7.3f %7.2f %7.3f %7.2f %7.2f %9.3f\n",
+           g.ang_p, g.ang_i, g.ang_d, g.spd_p, g.spd_i, g.gravity_ff, g.accel_ff,
+           r.fell ? "yes" : "no", r.t_alive_s, r.pitch_rms, r.pitch_max, r.drift_m, r.spd_err_rms,
+           r.torque_rms, r.cost);
+}
+
+int run_sim(uint32_t dt_us)
+{
+    if (dt_us != 0)
+        robot.dt_us = dt_us;
+    robot.dt = robot.dt_us * 1e-6f;
+    const sim_scenario sc = sim_default_scenario();
+    const sim_gains g = sim_default_gains();
+    const auto t0 = clock_type::now();
+    const sim_result r = sim_run(sim_default_plant(), g, sc);
+    const double wall = seconds_since(t0);
+
+    print_result_header();
+    print_result(g, r);
+    printf("dt_us=%u ", robot.dt_us);
+    printf("sim %.1f s in %.3f s wall (%.0fx real time), batt_min=%.2f V, state=%s\n",
+           sc.duration_s, wall, sc.duration_s / wall, r.batt_min, motion_state_name(robot.state));
+    return r.fell ? 1 : 0;
+}
+
+int run_sweep(int argc, char **argv)
+{
+    int jobs = static_cast<int>(std::thread::hardware_concurrency());
+    int top = 10;
+    std::vector<sweep_axis> axes;
+    for (int i = 0; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "-j") == 0 && i + 1 < argc)
+        {
+            jobs = atoi(argv[++i]);
+            continue;
+        }
+        if (strcmp(argv[i], "-top") == 0 && i + 1 < argc)
+        {
+            top = atoi(argv[++i]);
+            continue;
+        }
+        sweep_axis ax;
+        if (!sweep_parse_axis(argv[i], ax))
+        {
+            fprintf(stderr, "bad axis '%s', expect name=lo:hi:n\n", argv[i]);
+            return 2;
+        }
+        axes.push_back(ax);
+    }
+
+    const sim_scenario sc = sim_default_scenario();
+    const auto t0 = clock_type::now();
+    const std::vector<sweep_point> pts = sweep_run(sim_default_plant(), sim_default_gains(), sc, axes, jobs);
+    const double wall = seconds_since(t0);
+
+    print_result_header();
+    for (size_t i = 0; i < pts.size() && static_cast<int>(i) < top; ++i)
+        print_result(pts[i].gains, pts[i].result);
+    printf("%zu runs x %.1f s sim on %d jobs in %.2f s wall (%.0fx real time)\n",
+           pts.size(), sc.duration_s, jobs, wall, pts.size() * sc.duration_s / wall);
+    return 0;
+}
+// 旧分发方式：按处理器顺序逐个 strcmp
+int find_linear(const char *type)
+{
+    for (int i = 0; i < NET_CMD_COUNT; ++i)
+    {
+        if (strcmp(net_cmd_infos[i].type, type) == 0)
+            return i;
+    }
+    return -1;
+}
+
+template <typename F>
+double ns_per_call(F find, const char *type, unsigned long iters)
+{
+    volatile int sink = 0;
+    const auto t0 = clock_type::now();
+    for (unsigned long i = 0; i < iters; ++i)
+        sink = sink + find(type);
+    return seconds_since(t0) * 1e9 / iters;
+}
+
+int run_dispatch(unsigned long iters)
+{
+    // 运行时拷贝类型字符串，避免编译器把查找常量折叠掉
+    std::vector<std::string> types;
+    for (const net_cmd_info &c : net_cmd_infos)
+        types.push_back(c.type);
+    types.push_back("no_such_cmd");
+
+    double sum_hash = 0, sum_linear = 0;
+    printf("%-18s %10s %10s\n", "type", "hash ns", "strcmp ns");
+    for (const std::string &t : types)
+    {
+        const double h = ns_per_call(net_cmd_find, t.c_str(), iters);
+        const double l = ns_per_call(find_linear, t.c_str(), iters);
+        sum_hash += h;
+        sum_linear += l;
+        printf("%-18s %10.1f %10.1f\n", t.c_str(), h, l);
+    }
+    printf("avg over %zu types: hash %.1f ns, strcmp chain %.1f ns\n", types.size(),
+           sum_hash / types.size(), sum_linear / types.size());
+    return 0;
+}
+// 旧实现：按 Adafruit_SSD1306::drawPixel（无旋转）逐像素写显存
+void ref_pixel(uint8_t *buf, uint16_t w, uint16_t x, uint16_t y, bool on)
+{
+    uint8_t &b = buf[x + (y / 8) * w];
+    if (on)
+        b |= 1 << (y & 7);
+    else
+        b &= ~(1 << (y & 7));
+}
+
+void ref_mono(const uint8_t *data, uint8_t *buf, uint16_t w, uint16_t h)
+{
+    size_t idx = 0;
+    for (uint16_t y = 0; y < h; ++y)
+        for (uint16_t x = 0; x < w; x += 8)
+        {
+            const uint8_t byte = data[idx++];
+            for (uint8_t b = 0; b < 8; ++b)
+                ref_pixel(buf, w, x + b, y, byte & (1 << (7 - b)));
+        }
+}
+
+void ref_rgb565(const uint8_t *data, uint8_t *buf, uint16_t w, uint16_t h)
+{
+    size_t idx = 0;
+    for (uint16_t y = 0; y < h; ++y)
+        for (uint16_t x = 0; x < w; ++x)
+        {
+            const uint8_t lo = data[idx++];
+            const uint8_t hi = data[idx++];
+            const uint16_t v = (hi << 8) | lo;
+            const uint8_t r = (v >> 11) & 0x1F;
+            const uint8_t g = (v >> 5) & 0x3F;
+            const uint8_t b = v & 0x1F;
+            const uint16_t gray = (r * 527 + g * 259 + b * 527) >> 6;
+            ref_pixel(buf, w, x, y, gray > 512);
+        }
+}
+
+template <typename F>
+double us_per_frame(F convert, unsigned long iters)
+{
+    const auto t0 = clock_type::now();
+    for (unsigned long i = 0; i < iters; ++i)
+        convert();
+    return seconds_since(t0) * 1e6 / iters;
+}
+
+int run_screen(unsigned long iters)
+{
+    constexpr uint16_t W = SCREEN_WIDTH, H = SCREEN_HEIGHT;
+    std::vector<uint8_t> mono(W * H / 8), rgb(W * H * 2);
+    std::vector<uint8_t> ref(W * H / 8), out(W * H / 8);
+    srand(1);
+    for (uint8_t &b : mono)
+        b = static_cast<uint8_t>(rand());
+    for (uint8_t &b : rgb)
+        b = static_cast<uint8_t>(rand());
+    // 覆盖阈值附近的全部 rgb565 取值
+    for (size_t i = 0; i < W * H; ++i)
+    {
+        const uint16_t v = static_cast<uint16_t>(i * 8);
+        rgb[i * 2] = v & 0xFF;
+        rgb[i * 2 + 1] = v >> 8;
+    }
+
+    ref_mono(mono.data(), ref.data(), W, H);
+    pix_mono_to_pages(mono.data(), out.data(), W, H);
+    const bool mono_ok = ref == out;
+    ref_rgb565(rgb.data(), ref.data(), W, H);
+    pix_rgb565_to_pages(rgb.data(), out.data(), W, H, false);
+    const bool rgb_ok = ref == out;
+
+    const double t_ref_mono = us_per_frame([&] { ref_mono(mono.data(), ref.data(), W, H); }, iters);
+    const double t_mono = us_per_frame([&] { pix_mono_to_pages(mono.data(), out.data(), W, H); }, iters);
+    const double t_ref_rgb = us_per_frame([&] { ref_rgb565(rgb.data(), ref.data(), W, H); }, iters);
+    const double t_rgb = us_per_frame([&] { pix_rgb565_to_pages(rgb.data(), out.data(), W, H, false); }, iters);
+    const double t_dither = us_per_frame([&] { pix_rgb565_to_pages(rgb.data(), out.data(), W, H, true); }, iters);
+
+    printf("%-14s %10s %10s %6s\n", "mode", "per-pixel", "batched", "match");
+    printf("%-14s %8.2f us %8.2f us %6s\n", "mono", t_ref_mono, t_mono, mono_ok ? "yes" : "NO");
+    printf("%-14s %8.2f us %8.2f us %6s\n", "rgb565", t_ref_rgb, t_rgb, rgb_ok ? "yes" : "NO");
+    printf("%-14s %11s %8.2f us\n", "rgb565_dither", "-", t_dither);
+    return mono_ok && rgb_ok ? 0 : 1;
+}
+} // namespace
+
+int main(int argc, char **argv)
+{
+    if (argc > 1 && strcmp(argv[1], "sim") == 0)
+        return run_sim((argc > 2) ? strtoul(argv[2], nullptr, 10) : 0U);
+    if (argc > 1 && strcmp(argv[1], "sweep") == 0)
+        return run_sweep(argc - 2, argv + 2);
+    if (argc > 1 && strcmp(argv[1], "dispatch") == 0)
+        return run_dispatch((argc > 2) ? strtoul(argv[2], nullptr, 10) : 1000000UL);
+    if (argc > 1 && strcmp(argv[1], "screen") == 0)
+        return run_screen((argc > 2) ? strtoul(argv[2], nullptr, 10) : 2000UL);
+    if (argc > 1 && strcmp(argv[1], "bench") == 0)
+        return run_bench((argc > 2) ? strtoul(argv[2], nullptr, 10) : 100000UL);
+    return run_bench(100000UL);
+}
+// 说明：主机构建入口，控制周期基准、倒立摆仿真、并行参数扫描、指令分发与屏幕转换基准
@@ -0,0 +1,147 @@
+#include <chrono>
+#include "my_hal_native.h"
+#include "my_config.h"
+
+// 主机构建下由假设备提供电池电压，仿真可直接写入模拟压降
+float battery_voltage = BAT_FULL_VOLTAGE;
+
+namespace
+{
+uint64_t now_us = 0;
+hal_imu_sample imu{0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f};
+float wheel_L = 0.0f;
+float wheel_R = 0.0f;
+bool sensors_alive = true;
+hal_fake_motor motor{HalMotorLoop::Torque, 0.0f, 0.0f, BAT_FULL_VOLTAGE, BAT_FULL_VOLTAGE * 0.85f, 0};
+uint8_t warm_mem[WARM_MEM_BYTES]; // hal_fake_reset 不清空，模拟复位后保留
+bool warm_reset = false;
+} // namespace
+
+void hal_fake_reset()
+{
+    now_us = 0;
+    imu = {0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f};
+    wheel_L = wheel_R = 0.0f;
+    sensors_alive = true;
+    motor = {HalMotorLoop::Torque, 0.0f, 0.0f, BAT_FULL_VOLTAGE, BAT_FULL_VOLTAGE * 0.85f, 0};
+    battery_voltage = BAT_FULL_VOLTAGE;
+    warm_reset = false;
+    hal_fake_storage_clear();
+}
+
+void hal_fake_set_time_us(uint64_t t_us)
+{
+    now_us = t_us;
+}
+
+void hal_fake_advance_us(uint32_t dt_us)
+{
+    now_us += dt_us;
+}
+
+uint64_t hal_fake_time_us()
+{
+    return now_us;
+}
+
+void hal_fake_set_imu(const hal_imu_sample &s)
+{
+    imu = s;
+}
+
+void hal_fake_set_wheels(float wL, float wR)
+{
+    wheel_L = wL;
+    wheel_R = wR;
+}
+
+void hal_fake_set_sensors_alive(bool alive)
+{
+    sensors_alive = alive;
+}
+
+const hal_fake_motor &hal_fake_motor_state()
+{
+    return motor;
+}
+
+void hal_fake_set_warm_reset(bool warm)
+{
+    warm_reset = warm;
+}
+
+// ---------------- my_hal 接口 ----------------
+
+uint32_t hal_millis()
+{
+    return static_cast<uint32_t>(now_us / 1000U);
+}
+
+uint32_t hal_micros()
+{
+    return static_cast<uint32_t>(now_us);
+}
+
+// 剖析计数器走真实时钟（ns），用于度量主机上的实际耗时
+uint32_t hal_cycles()
+{
+    using namespace std::chrono;
+    return static_cast<uint32_t>(duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count());
+}
+
+uint32_t hal_cycles_per_us()
+{
+    return 1000U;
+}
+
+void hal_imu_read(hal_imu_sample &out, uint32_t &t_us)
+{
+    out = imu;
+    t_us = static_cast<uint32_t>(now_us);
+}
+
+void hal_wheel_read(float &wL, float &wR)
+{
+    wL = wheel_L;
+    wR = wheel_R;
+}
+
+void hal_sense_read(hal_sense_snapshot &out)
+{
+    out.imu = imu;
+    out.imu_us = static_cast<uint32_t>(now_us);
+    out.wL = wheel_L;
+    out.wR = wheel_R;
+    out.wheel_us = static_cast<uint32_t>(now_us);
+    out.alive = sensors_alive;
+}
+
+void hal_motor_set_supply(float supply_v, float voltage_limit)
+{
+    motor.supply_v = supply_v;
+    motor.voltage_limit = voltage_limit;
+}
+
+void hal_motor_output(HalMotorLoop loop, float target_L, float target_R)
+{
+    motor.loop = loop;
+    motor.target_L = target_L;
+    motor.target_R = target_R;
+    motor.commutations++;
+}
+
+bool hal_sensors_alive()
+{
+    return sensors_alive;
+}
+
+uint8_t *hal_warm_mem()
+{
+    return warm_mem;
+}
+
+bool hal_warm_reset()
+{
+    return warm_reset;
+}
+// 说明：my_hal 的主机实现，虚拟时钟与可注入的 IMU/编码器/电机假设备
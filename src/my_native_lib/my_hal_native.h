@@ -0,0 +1,37 @@
+#pragma once
+
+#include <stdint.h>
+#include "my_hal.h"
+
+// 主机假设备：仿真/基准代码通过这些接口注入传感器数据、推进时钟并读取电机输出
+
+// 最近一次下发的电机命令
+struct hal_fake_motor
+{
+    HalMotorLoop loop;
+    float target_L;
+    float target_R;
+    float supply_v;
+    float voltage_limit;
+    uint32_t commutations; // hal_motor_output 调用次数
+};
+
+// 清空全部假设备状态（时钟归零、传感器静止、存储清空）
+void hal_fake_reset();
+
+// 虚拟时钟，单位 us
+void hal_fake_set_time_us(uint64_t t_us);
+void hal_fake_advance_us(uint32_t dt_us);
+uint64_t hal_fake_time_us();
+
+void hal_fake_set_imu(const hal_imu_sample &s);
+void hal_fake_set_wheels(float wL, float wR);
+void hal_fake_set_sensors_alive(bool alive);
+
+const hal_fake_motor &hal_fake_motor_state();
+
+// 下一次 my_motion_init 视为软件复位（保留区内容沿用上次运行），hal_fake_reset 后恢复为冷启动
+void hal_fake_set_warm_reset(bool warm);
+
+// 内存版 NVS
+void hal_fake_storage_clear();
@@ -0,0 +1,291 @@
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include "my_sim.h"
+#include "my_hal_native.h"
+#include "my_motion.h"
+#include "my_ahrs.h"
+#include "my_control.h"
+#include "my_bat.h"
+
+namespace
+{
+constexpr float G = 9.81f;
+constexpr float R2D = 180.0f / PI;
+constexpr float D2R = PI / 180.0f;
+constexpr float W_EPS = 1e-3f; // 视为静止的轮速 (rad/s)
+
+// 对象状态：x 为轮轴前进位移，theta 为真实俯仰（向 +x 倾为正），psi 为航向
+struct plant_state
+{
+    float x, dx;
+    float theta, dtheta;
+    float psi, dpsi;
+    float ddx; // 上一步轮轴加速度，用于合成加速度计读数
+};
+
+float clampf(float v, float lo, float hi)
+{
+    return (v < lo) ? lo : ((v > hi) ? hi : v);
+}
+
+float signf(float v)
+{
+    return (v > 0.0f) ? 1.0f : ((v < 0.0f) ? -1.0f : 0.0f);
+}
+
+// 电机电压模式：目标即 Uq，经供电与 voltage_limit 截断后按反电动势求电流
+float motor_current(const sim_plant &p, float target_v, float limit_v, float w_motor)
+{
+    const float u = clampf(target_v, -limit_v, limit_v);
+    return (u - p.motor_kt * w_motor) / p.motor_r;
+}
+
+// 库仑摩擦：静止时小于摩擦的力矩被完全吃掉，运动时反向衰减
+float apply_friction(float tau, float w, float friction)
+{
+    if (fabsf(w) > W_EPS)
+        return tau - signf(w) * friction;
+    if (fabsf(tau) <= friction)
+        return 0.0f;
+    return tau - signf(tau) * friction;
+}
+
+void wheel_speeds(const sim_plant &p, const plant_state &s, float &wL, float &wR)
+{
+    const float k = p.wheel_track / (2.0f * p.wheel_radius);
+    wL = s.dx / p.wheel_radius - k * s.dpsi;
+    wR = s.dx / p.wheel_radius + k * s.dpsi;
+}
+
+// 积分一步；held 为真时车体俯仰被“手”扶住，仅轮子可动
+void plant_step(const sim_plant &p, plant_state &s, float tau_L, float tau_R, bool held, float h)
+{
+    const float M = p.body_mass;
+    const float l = p.cog_height;
+    const float r = p.wheel_radius;
+    const float tau = tau_L + tau_R;
+    const float c = cosf(s.theta);
+    const float sn = sinf(s.theta);
+
+    const float a11 = M + 2.0f * p.wheel_mass + 2.0f * p.wheel_inertia / (r * r);
+    float ddx = 0.0f;
+    float ddtheta = 0.0f;
+    if (held)
+    {
+        ddx = tau / r / a11;
+    }
+    else
+    {
+        const float a12 = M * l * c;
+        const float a22 = p.body_inertia + M * l * l;
+        const float b1 = tau / r + M * l * s.dtheta * s.dtheta * sn;
+        const float b2 = M * G * l * sn - tau;
+        const float det = a11 * a22 - a12 * a12;
+        ddx = (b1 * a22 - a12 * b2) / det;
+        ddtheta = (a11 * b2 - a12 * b1) / det;
+    }
+
+    const float k = p.wheel_track / (2.0f * r);
+    const float jz = p.yaw_inertia + 2.0f * k * k * p.wheel_inertia +
+                     0.5f * p.wheel_mass * p.wheel_track * p.wheel_track;
+    const float ddpsi = (tau_R - tau_L) * k / jz;
+
+    // 半隐式欧拉
+    s.dx += ddx * h;
+    s.x += s.dx * h;
+    s.dtheta += ddtheta * h;
+    s.theta += s.dtheta * h;
+    s.dpsi += ddpsi * h;
+    s.psi += s.dpsi * h;
+    s.ddx = ddx;
+    if (held)
+        s.theta = s.dtheta = 0.0f;
+}
+} // namespace
+
+sim_plant sim_default_plant()
+{
+    sim_plant p{};
+    p.body_mass = 0.55f;
+    p.cog_height = 0.05f;
+    p.body_inertia = 0.0012f;
+    p.wheel_radius = 0.034f;
+    p.wheel_mass = 0.03f;
+    p.wheel_inertia = 0.5f * 0.03f * 0.034f * 0.034f + 1.0e-5f;
+    p.wheel_track = 0.14f;
+    p.yaw_inertia = 0.0015f;
+    p.motor_kt = 0.0955f; // KV≈100
+    p.motor_r = 5.0f;
+    p.motor_friction = 0.004f;
+    p.motor_dir = -1.0f;
+    p.batt_v_open = 12.0f;
+    p.batt_r_int = 0.15f;
+    p.imu_offset_deg = -2.1f;
+    p.acc_noise_g = 0.01f;
+    p.gyro_noise_dps = 0.1f;
+    return p;
+}
+
+sim_gains sim_default_gains()
+{
+    // 与 my_motion.cpp 中 robot 初值及 my_config.h 的前馈默认一致
+    return sim_gains{0.6f, 5.0f, 0.016f, 0.003f, 0.0001f, GRAVITY_FF_GAIN, ACCEL_FF_GAIN};
+}
+
+sim_scenario sim_default_scenario()
+{
+    sim_scenario sc{};
+    sc.duration_s = 12.0f;
+    sc.push_at_s = 1.0f;
+    sc.push_dps = 30.0f;
+    sc.joy_at_s = 4.0f;
+    sc.joy_hold_s = 2.0f;
+    sc.joy_y = 0.5f;
+    sc.substep_us = 250.0f;
+    sc.seed = 1;
+    return sc;
+}
+
+sim_result sim_run(const sim_plant &p, const sim_gains &g, const sim_scenario &sc)
+{
+    hal_fake_reset();
+
+    robot.ang_pid.p = g.ang_p;
+    robot.ang_pid.i = g.ang_i;
+    robot.ang_pid.d = g.ang_d;
+    robot.spd_pid.p = g.spd_p;
+    robot.spd_pid.i = g.spd_i;
+    gravity_ff_gain = g.gravity_ff;
+    accel_ff_gain = g.accel_ff;
+
+    my_motion_init();
+    robot.run = true; // 等价于网页端一上电就点“运行”
+
+    std::mt19937 rng(sc.seed);
+    std::normal_distribution<float> acc_n(0.0f, p.acc_noise_g);
+    std::normal_distribution<float> gyro_n(0.0f, p.gyro_noise_dps);
+
+    plant_state s{};
+    sim_result res{};
+    res.batt_min = p.batt_v_open;
+
+    const uint32_t dt_us = robot.dt_us;
+    const int substeps = std::max(1, static_cast<int>(dt_us / sc.substep_us));
+    const float h = dt_us * 1e-6f / substeps;
+    const uint32_t total_cycles = static_cast<uint32_t>(sc.duration_s * 1e6f / dt_us);
+
+    bool held = true;
+    bool pushed = false;
+    float t_release = 0.0f;
+    float x_release = 0.0f;
+    double pitch_sq = 0.0, torque_sq = 0.0, spd_sq = 0.0;
+    uint32_t n_free = 0;
+
+    for (uint32_t cyc = 0; cyc < total_cycles; ++cyc)
+    {
+        const float t = cyc * dt_us * 1e-6f;
+
+        // 场景事件
+        if (held && robot.state == MotionState::Normal)
+        {
+            held = false;
+            res.released = true;
+            t_release = t;
+            x_release = s.x;
+        }
+        const float t_free = t - t_release;
+        if (!held && !pushed && t_free >= sc.push_at_s)
+        {
+            s.dtheta += sc.push_dps * D2R;
+            pushed = true;
+        }
+        if (!held)
+        {
+            const bool joy_on = t_free >= sc.joy_at_s && t_free < sc.joy_at_s + sc.joy_hold_s;
+            robot.joy.y = joy_on ? sc.joy_y : 0.0f;
+        }
+
+        // 传感器合成（加速度计含轮轴平动加速度）
+        const float th = s.theta;
+        const float pitch_meas = th + p.imu_offset_deg * D2R;
+        hal_imu_sample imu;
+        imu.ax = (s.ddx * cosf(pitch_meas) - G * sinf(pitch_meas)) / G + acc_n(rng);
+        imu.ay = acc_n(rng);
+        imu.az = (s.ddx * sinf(pitch_meas) + G * cosf(pitch_meas)) / G + acc_n(rng);
+        imu.gx = gyro_n(rng);
+        imu.gy = s.dtheta * R2D + gyro_n(rng);
+        imu.gz = p.motor_dir * s.dpsi * R2D + gyro_n(rng);
+        hal_fake_set_imu(imu);
+
+        float wL, wR;
+        wheel_speeds(p, s, wL, wR);
+        hal_fake_set_wheels(p.motor_dir * wL, p.motor_dir * wR);
+
+        // 与 control_task 相同的调用顺序
+        hal_fake_advance_us(dt_us);
+        hal_sense_snapshot snap;
+        hal_sense_read(snap);
+        ahrs_update(robot, snap.imu, robot.dt);
+        my_motion_update(snap);
+        my_motor_update();
+        res.cycles++;
+
+        // 零阶保持电机命令，细分积分对象
+        const hal_fake_motor &m = hal_fake_motor_state();
+        const bool torque_loop = (m.loop == HalMotorLoop::Torque);
+        const float tgt_L = torque_loop ? m.target_L : 0.0f;
+        const float tgt_R = torque_loop ? m.target_R : 0.0f;
+        float i_sum = 0.0f;
+        for (int k = 0; k < substeps; ++k)
+        {
+            wheel_speeds(p, s, wL, wR);
+            const float limit = std::min(m.voltage_limit, battery_voltage);
+            const float iL = motor_current(p, tgt_L, limit, p.motor_dir * wL);
+            const float iR = motor_current(p, tgt_R, limit, p.motor_dir * wR);
+            const float tau_L = apply_friction(p.motor_dir * p.motor_kt * iL, wL, p.motor_friction);
+            const float tau_R = apply_friction(p.motor_dir * p.motor_kt * iR, wR, p.motor_friction);
+            plant_step(p, s, tau_L, tau_R, held, h);
+            i_sum += fabsf(iL) + fabsf(iR);
+        }
+
+        // 电池负载压降（控制环在下一周期通过 battery_voltage 感知）
+        battery_voltage = p.batt_v_open - p.batt_r_int * (i_sum / substeps);
+        res.batt_min = std::min(res.batt_min, battery_voltage);
+
+        if (!held)
+        {
+            const float pitch_deg = s.theta * R2D;
+            pitch_sq += pitch_deg * pitch_deg;
+            torque_sq += 0.5 * (tgt_L * tgt_L + tgt_R * tgt_R);
+            spd_sq += robot.spd.err * robot.spd.err;
+            n_free++;
+            res.pitch_max = std::max(res.pitch_max, fabsf(pitch_deg));
+            res.t_alive_s = t + dt_us * 1e-6f - t_release;
+            if (robot.state == MotionState::Fallen || fabsf(pitch_deg) > 60.0f)
+            {
+                res.fell = true;
+                break;
+            }
+        }
+    }
+
+    if (n_free > 0)
+    {
+        res.pitch_rms = sqrtf(pitch_sq / n_free);
+        res.torque_rms = sqrtf(torque_sq / n_free);
+        res.spd_err_rms = sqrtf(spd_sq / n_free);
+    }
+    res.drift_m = s.x - x_release;
+
+    // 代价：摔倒远劣于任何站稳结果；站稳时综合姿态误差、用力与速度跟踪
+    const float free_time = sc.duration_s - t_release;
+    if (!res.released)
+        res.cost = 1e4f;
+    else if (res.fell)
+        res.cost = 1e3f + (free_time - res.t_alive_s);
+    else
+        res.cost = res.pitch_rms + 0.1f * res.torque_rms + 0.2f * res.spd_err_rms;
+    return res;
+}
+// 说明：两轮倒立摆对象模型（车体/轮/航向 + 电压模式电机 + 电池内阻），闭环驱动运动库
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <stdint.h>
+
+// 两轮倒立摆主机仿真：以 robot.dt_us 闭环驱动 my_motion_update(snap)/my_motor_update()
+
+// 被控对象参数（默认值对应 2804 云台电机 + 3S 电池的小车）
+struct sim_plant
+{
+    float body_mass;      // 车体质量 (kg)，不含车轮
+    float cog_height;     // 重心到轮轴距离 (m)
+    float body_inertia;   // 车体绕重心转动惯量 (kg·m²)
+    float wheel_radius;   // 轮半径 (m)
+    float wheel_mass;     // 单轮质量 (kg)
+    float wheel_inertia;  // 单轮+转子转动惯量 (kg·m²)
+    float wheel_track;    // 轮距 (m)
+    float yaw_inertia;    // 车体绕竖直轴转动惯量 (kg·m²)
+    float motor_kt;       // 力矩常数 (Nm/A)，同时作为反电动势常数 (V·s/rad)
+    float motor_r;        // 相电阻 (Ω)
+    float motor_friction; // 库仑摩擦力矩 (Nm)，决定死区
+    float motor_dir;      // 正目标对应的前进方向（±1）
+    float batt_v_open;    // 电池开路电压 (V)
+    float batt_r_int;     // 电池内阻 (Ω)，产生负载压降
+    float imu_offset_deg; // IMU 安装俯仰偏差 (deg)
+    float acc_noise_g;    // 加速度噪声标准差 (g)
+    float gyro_noise_dps; // 陀螺噪声标准差 (deg/s)
+};
+
+// 待整定参数（写入 robot.ang_pid / spd_pid 与前馈增益）
+struct sim_gains
+{
+    float ang_p, ang_i, ang_d;
+    float spd_p, spd_i;
+    float gravity_ff;
+    float accel_ff;
+};
+
+// 试验场景：扶正上电 → 运行后松手 → 推一下 → 摇杆前进再停下
+struct sim_scenario
+{
+    float duration_s;     // 总仿真时长 (s)
+    float push_at_s;      // 松手后多久施加扰动 (s)
+    float push_dps;       // 扰动：俯仰角速度突变 (deg/s)
+    float joy_at_s;       // 松手后多久推摇杆 (s)
+    float joy_hold_s;     // 摇杆保持时长 (s)
+    float joy_y;          // 摇杆 y 值
+    float substep_us;     // 对象积分步长 (us)
+    uint32_t seed;        // 噪声种子
+};
+
+struct sim_result
+{
+    bool released;      // 是否进入 Normal 并松手
+    bool fell;          // 是否摔倒
+    float t_alive_s;    // 松手后保持站立时长 (s)
+    float pitch_rms;    // 松手后真实倾角 RMS (deg)
+    float pitch_max;    // 松手后最大倾角 (deg)
+    float drift_m;      // 结束时相对松手点的位移 (m)
+    float spd_err_rms;  // 速度环跟踪误差 RMS (rad/s)
+    float torque_rms;   // 电机电压目标 RMS (V)
+    float batt_min;     // 最低电池电压 (V)
+    float cost;         // 综合代价，越小越好
+    uint32_t cycles;    // 控制周期数
+};
+
+sim_plant sim_default_plant();
+sim_gains sim_default_gains();
+sim_scenario sim_default_scenario();
+
+// 跑一次闭环仿真。运动库使用全局状态，每次调用需在全新进程中进行
+sim_result sim_run(const sim_plant &plant, const sim_gains &gains, const sim_scenario &sc);
@@ -0,0 +1,157 @@
+#include "my_storage.h"
+#include "my_hal_native.h"
+
+namespace
+{
+storage_settings cur{};
+
+void pid_pack(storage_settings &s, const cmd_pid &pid)
+{
+    s.pid_ang_p = pid.ang_p;
+    s.pid_ang_i = pid.ang_i;
+    s.pid_ang_d = pid.ang_d;
+    s.pid_spd_p = pid.spd_p;
+    s.pid_spd_i = pid.spd_i;
+    s.pid_spd_d = pid.spd_d;
+    s.pid_yaw_p = pid.yaw_p;
+    s.pid_yaw_i = pid.yaw_i;
+    s.pid_yaw_d = pid.yaw_d;
+}
+
+void pid_unpack(const storage_settings &s, cmd_pid &pid)
+{
+    pid.ang_p = s.pid_ang_p;
+    pid.ang_i = s.pid_ang_i;
+    pid.ang_d = s.pid_ang_d;
+    pid.spd_p = s.pid_spd_p;
+    pid.spd_i = s.pid_spd_i;
+    pid.spd_d = s.pid_spd_d;
+    pid.yaw_p = s.pid_yaw_p;
+    pid.yaw_i = s.pid_yaw_i;
+    pid.yaw_d = s.pid_yaw_d;
+}
+} // namespace
+
+void hal_fake_storage_clear()
+{
+    cur = storage_settings{};
+}
+
+bool storage_load_calib(float &dzL, float &dzR)
+{
+    if (!(cur.present & STORAGE_CALIB))
+        return false;
+    dzL = cur.dzL;
+    dzR = cur.dzR;
+    return true;
+}
+
+void storage_save_calib(float dzL, float dzR)
+{
+    cur.dzL = dzL;
+    cur.dzR = dzR;
+    cur.present |= STORAGE_CALIB;
+}
+
+bool storage_load_gyro_bias(float &gx, float &gy, float &gz)
+{
+    if (!(cur.present & STORAGE_GYRO))
+        return false;
+    gx = cur.gx;
+    gy = cur.gy;
+    gz = cur.gz;
+    return true;
+}
+
+void storage_save_gyro_bias(float gx, float gy, float gz)
+{
+    cur.gx = gx;
+    cur.gy = gy;
+    cur.gz = gz;
+    cur.present |= STORAGE_GYRO;
+}
+
+bool storage_load_foc_align(uint8_t motor, float &zero_angle, int8_t &direction)
+{
+    if (motor > 1 || !(cur.present & (motor == 0 ? STORAGE_FOC_L : STORAGE_FOC_R)))
+        return false;
+    zero_angle = cur.foc_zero[motor];
+    direction = cur.foc_dir[motor];
+    return true;
+}
+
+void storage_save_foc_align(uint8_t motor, float zero_angle, int8_t direction)
+{
+    if (motor > 1)
+        return;
+    cur.foc_zero[motor] = zero_angle;
+    cur.foc_dir[motor] = direction;
+    cur.present |= motor == 0 ? STORAGE_FOC_L : STORAGE_FOC_R;
+}
+
+void storage_clear_foc_align()
+{
+    cur.present &= ~(STORAGE_FOC_L | STORAGE_FOC_R);
+}
+
+bool storage_load_pid(cmd_pid &out)
+{
+    if (!(cur.present & STORAGE_PID))
+        return false;
+    pid_unpack(cur, out);
+    return true;
+}
+
+void storage_save_pid(const cmd_pid &pid)
+{
+    pid_pack(cur, pid);
+    cur.present |= STORAGE_PID;
+}
+
+bool storage_load_torque_limit(float &out)
+{
+    if (!(cur.present & STORAGE_TORQUE_LIMIT))
+        return false;
+    out = cur.torque_limit;
+    return true;
+}
+
+void storage_save_torque_limit(float value)
+{
+    cur.torque_limit = value;
+    cur.present |= STORAGE_TORQUE_LIMIT;
+}
+
+bool storage_load_pitch_zero(float &out)
+{
+    if (!(cur.present & STORAGE_PITCH_ZERO))
+        return false;
+    out = cur.pitch_zero;
+    return true;
+}
+
+void storage_save_pitch_zero(float value)
+{
+    cur.pitch_zero = value;
+    cur.present |= STORAGE_PITCH_ZERO;
+}
+
+// 内存副本直接写入，无需读入与后台任务
+void storage_start()
+{
+}
+
+void storage_flush()
+{
+}
+
+const char *storage_origin_name(StorageOrigin origin)
+{
+    return origin == StorageOrigin::Empty ? "empty" : "unknown";
+}
+
+storage_stats storage_get_stats()
+{
+    return storage_stats{};
+}
+// 说明：my_storage 的主机实现，以内存中的配置副本代替 NVS blob
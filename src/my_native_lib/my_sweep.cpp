@@ -0,0 +1,126 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "my_sweep.h"
+
+namespace
+{
+float *gain_field(sim_gains &g, const char *name)
+{
+    if (strcmp(name, "ang_p") == 0) return &g.ang_p;
+    if (strcmp(name, "ang_i") == 0) return &g.ang_i;
+    if (strcmp(name, "ang_d") == 0) return &g.ang_d;
+    if (strcmp(name, "spd_p") == 0) return &g.spd_p;
+    if (strcmp(name, "spd_i") == 0) return &g.spd_i;
+    if (strcmp(name, "gravity_ff") == 0) return &g.gravity_ff;
+    if (strcmp(name, "accel_ff") == 0) return &g.accel_ff;
+    return nullptr;
+}
+
+struct running_job
+{
+    size_t index;
+    int fd;
+};
+} // namespace
+
+bool sweep_parse_axis(const char *arg, sweep_axis &out)
+{
+    static char names[16][32];
+    static int used = 0;
+    const char *eq = strchr(arg, '=');
+    if (!eq || eq - arg >= 32 || used >= 16)
+        return false;
+    char *name = names[used];
+    memcpy(name, arg, eq - arg);
+    name[eq - arg] = '\0';
+    sim_gains probe{};
+    if (!gain_field(probe, name))
+        return false;
+    if (sscanf(eq + 1, "%f:%f:%d", &out.lo, &out.hi, &out.n) != 3 || out.n < 1)
+        return false;
+    out.name = name;
+    used++;
+    return true;
+}
+
+std::vector<sweep_point> sweep_run(const sim_plant &plant, const sim_gains &base, const sim_scenario &sc,
+                                   const std::vector<sweep_axis> &axes, int jobs)
+{
+    // 展开网格
+    std::vector<sweep_point> points(1, sweep_point{base, sim_result{}});
+    for (const sweep_axis &ax : axes)
+    {
+        std::vector<sweep_point> next;
+        next.reserve(points.size() * ax.n);
+        for (const sweep_point &pt : points)
+        {
+            for (int i = 0; i < ax.n; ++i)
+            {
+                sweep_point q = pt;
+                const float v = (ax.n == 1) ? ax.lo : ax.lo + (ax.hi - ax.lo) * i / (ax.n - 1);
+                *gain_field(q.gains, ax.name) = v;
+                next.push_back(q);
+            }
+        }
+        points.swap(next);
+    }
+
+    if (jobs < 1)
+        jobs = 1;
+    fflush(stdout);
+
+    std::map<pid_t, running_job> running;
+    size_t next_index = 0;
+    while (next_index < points.size() || !running.empty())
+    {
+        while (next_index < points.size() && static_cast<int>(running.size()) < jobs)
+        {
+            int fds[2];
+            if (pipe(fds) != 0)
+            {
+                perror("pipe");
+                exit(1);
+            }
+            const pid_t pid = fork();
+            if (pid < 0)
+            {
+                perror("fork");
+                exit(1);
+            }
+            if (pid == 0)
+            {
+                // 子进程：全新的运动库全局状态，跑完写回结果（小于 PIPE_BUF，原子写）
+                close(fds[0]);
+                const sim_result r = sim_run(plant, points[next_index].gains, sc);
+                ssize_t n = write(fds[1], &r, sizeof(r));
+                _exit(n == static_cast<ssize_t>(sizeof(r)) ? 0 : 1);
+            }
+            close(fds[1]);
+            running[pid] = running_job{next_index, fds[0]};
+            next_index++;
+        }
+
+        int status = 0;
+        const pid_t done = waitpid(-1, &status, 0);
+        auto it = running.find(done);
+        if (it == running.end())
+            continue;
+        sim_result r{};
+        if (read(it->second.fd, &r, sizeof(r)) != static_cast<ssize_t>(sizeof(r)))
+            r.cost = 1e9f; // 子进程异常退出
+        close(it->second.fd);
+        points[it->second.index].result = r;
+        running.erase(it);
+    }
+
+    std::sort(points.begin(), points.end(), [](const sweep_point &a, const sweep_point &b) {
+        return a.result.cost < b.result.cost;
+    });
+    return points;
+}
+// 说明：基于 fork 进程池的仿真参数网格扫描，铺满主机全部核心
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <vector>
+#include "my_sim.h"
+
+// 参数扫描轴：name 为 sim_gains 字段名（ang_p/ang_i/ang_d/spd_p/spd_i/gravity_ff/accel_ff）
+struct sweep_axis
+{
+    const char *name;
+    float lo;
+    float hi;
+    int n;
+};
+
+struct sweep_point
+{
+    sim_gains gains;
+    sim_result result;
+};
+
+// 解析 "name=lo:hi:n"，失败返回 false
+bool sweep_parse_axis(const char *arg, sweep_axis &out);
+
+// 笛卡尔网格扫描：每个点在 fork 出的全新子进程中跑 sim_run（运动库全局状态互不干扰），
+// 最多 jobs 个子进程并发；结果按代价升序返回
+std::vector<sweep_point> sweep_run(const sim_plant &plant, const sim_gains &base, const sim_scenario &sc,
+                                   const std::vector<sweep_axis> &axes, int jobs);
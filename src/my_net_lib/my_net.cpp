@@ -3,7 +3,6 @@
 #include <WiFi.h>
 #include <AsyncTCP.h>
 #include <Update.h>
-#include <unordered_map>
 #include <string.h>
 #include "my_net.h"
 #include "my_config.h"
@@ -16,17 +15,18 @@
 #include "net_state.h"
 #include "net_handlers.h"
 #include "net_persist.h"
+#include "my_cmd.h"
+#include "net_stream.h"
+#include "net_wire.h"
+#include "my_screen.h"
 #include "my_rgb.h"
+#include "my_storage.h"
 
 namespace
 {
-struct ClientMeta
-{
-    bool authed;
-};
-
-// ------------- Helpers -------------
-std::unordered_map<uint32_t, ClientMeta> client_meta;
+// 上行二进制帧被 TCP 拆成多段回调时在此拼接；整段到达时直接使用回调缓冲
+uint8_t bin_rx[sizeof(wire_screen) + SCREEN_WIDTH * SCREEN_HEIGHT / 8];
+uint32_t bin_rx_owner = 0;
 
 void wifi_start_ap()
 {
@@ -48,84 +48,88 @@ void wifi_restart()
     wifi_start_sta();
 }
 
-ClientMeta *ensure_meta(AsyncWebSocketClient *c)
-{
-    if (!c)
-        return nullptr;
-    auto &meta = client_meta[c->id()]; // default {false}
-    return &meta;
-}
-
 bool client_authed(AsyncWebSocketClient *c)
-{
-    ClientMeta *m = ensure_meta(c);
-    if (!m)
-        return false;
-    if (persist.ws_password.isEmpty())
-        m->authed = true;
-    return m->authed;
-}
-
-void free_meta(AsyncWebSocketClient *c)
-{
-    if (!c)
-        return;
-    client_meta.erase(c->id());
-}
-
-bool ensure_auth(AsyncWebSocketClient *client, const char *type)
 {
     if (persist.ws_password.isEmpty())
         return true;
-    if (client_authed(client))
-        return true;
-    if (strcmp(type, "auth") == 0 || strcmp(type, "state") == 0)
-        return true;
-    // 未认证，要求先 auth
-    send_state(client);
-    return false;
+    return c && net_client_authed(c->id());
 }
 
+// 指令表哈希查找，一次字符串比较确认；未识别的指令直接忽略
 void handle_command(AsyncWebSocketClient *client, JsonDocument &doc)
 {
     const char *type = doc["type"] | "";
-    if (!ensure_auth(client, type))
+    const int id = net_cmd_find(type);
+    if (id < 0)
         return;
-
-    if (handle_auth_cmd(client, type, doc))
+    if (!(net_cmd_infos[id].flags & NET_CMD_NO_AUTH) && !client_authed(client))
     {
-        // 认证成功时标记客户端已认证
-        const char *pwd = doc["password"] | "";
-        if (persist.ws_password.isEmpty() || persist.ws_password == pwd)
-        {
-            ClientMeta *m = ensure_meta(client);
-            if (m)
-                m->authed = true;
-        }
+        // 未认证，要求先 auth
+        send_state(client);
         return;
     }
-    if (handle_control_cmd(type, doc))
+    net_cmd_invoke(id, client, doc);
+}
+
+void handle_screen_frame(const uint8_t *data, size_t len)
+{
+    const wire_screen *f = reinterpret_cast<const wire_screen *>(data);
+    if (len < sizeof(wire_screen) || f->h.size < sizeof(wire_screen))
         return;
-    if (handle_freq_cmd(type, doc))
+    if (len < f->h.size + static_cast<size_t>(f->pages) * f->cols)
         return;
-    if (handle_pid_cmd(client, type, doc))
+    my_screen_blit_pages(f->page, f->pages, f->col, f->cols, data + f->h.size);
+}
+
+void handle_binary(AsyncWebSocketClient *client, const uint8_t *data, size_t len)
+{
+    const wire_header *h = reinterpret_cast<const wire_header *>(data);
+    if (len < sizeof(wire_header) || h->magic != NET_WIRE_MAGIC || h->version != NET_WIRE_VERSION)
         return;
-    if (handle_motion_cmd(type, doc))
+    if (!client_authed(client))
         return;
-    if (handle_rgb_cmd(type, doc))
+    switch (static_cast<WireKind>(h->kind))
+    {
+    case WireKind::Screen:
+        handle_screen_frame(data, len);
+        break;
+    default:
+        break;
+    }
+}
+
+void handle_ws_binary(AsyncWebSocketClient *client, AwsFrameInfo *info, uint8_t *data, size_t len)
+{
+    if (!info->final || info->num != 0 || info->len > sizeof(bin_rx))
         return;
-    if (handle_screen_cmd(type, doc))
+    if (info->index == 0 && info->len == len)
+    {
+        handle_binary(client, data, len);
         return;
-    if (handle_wifi_cmd(client, type, doc))
+    }
+    // 分段：同一时刻只拼一个客户端的帧，其他客户端的后续段丢弃
+    if (info->index == 0)
+        bin_rx_owner = client->id();
+    else if (bin_rx_owner != client->id())
         return;
-    if (handle_info_cmd(client, type, doc))
+    if (info->index + len > info->len)
         return;
-    // 未识别则忽略
+    memcpy(bin_rx + info->index, data, len);
+    if (info->index + len == info->len)
+    {
+        bin_rx_owner = 0;
+        handle_binary(client, bin_rx, info->len);
+    }
 }
 
 void handle_ws_message(AsyncWebSocketClient *client, void *arg, uint8_t *data, size_t len)
 {
     AwsFrameInfo *info = (AwsFrameInfo *)arg;
+    if (info->opcode == WS_BINARY)
+    {
+        handle_ws_binary(client, info, data, len);
+        return;
+    }
     if (!(info->final && info->index == 0 && info->len == len && info->opcode == WS_TEXT))
         return;
 
@@ -142,14 +146,15 @@ void ws_event(AsyncWebSocket *server, AsyncWebSocketClient *client, AwsEventType
     switch (type)
     {
     case WS_EVT_CONNECT:
-        ensure_meta(client);
+        net_client_add(client->id());
         send_state(client);
         break;
     case WS_EVT_DATA:
         handle_ws_message(client, arg, data, len);
         break;
     case WS_EVT_DISCONNECT:
-        free_meta(client);
+        net_stream_unsubscribe(client->id());
+        net_client_remove(client->id());
         break;
     default:
         break;
@@ -165,6 +170,7 @@ void handle_update_post(AsyncWebServerRequest *request)
     if (shouldReboot)
     {
         delay(200);
+        storage_flush();
         ESP.restart();
     }
 }
@@ -199,8 +205,11 @@ void my_net_push_state()
 
 void my_net_init()
 {
+    // 控制任务尚未启动，这里是网络侧唯一直接读取控制量的地方，用于给各副本取初值；
+    // robot.pitch_zero 已由 my_motion_init 从配置载入，热启动时为复位前的值
     net_persist_load(persist, robot.pitch_zero);
-    robot.pitch_zero = persist.pitch_zero;
+    persist.pid = cmd_pid_from(robot);
+    persist.torque_limit = torque_limit;
 
     WiFi.mode(WIFI_AP_STA);
     wifi_start_ap();
@@ -0,0 +1,81 @@
+// 说明：遥测通道登记表（名称、标签、数据来源），供 schema 与按通道订阅共用
+#include <string.h>
+#include "net_channels.h"
+#include "net_state.h"
+#include "my_chart.h"
+#include "my_prof.h"
+#include "my_motion.h"
+#include "net_wire.h"
+
+namespace
+{
+float loop_us()
+{
+    return prof_get(ProfStage::Busy).last_us;
+}
+
+float loop_p99()
+{
+    return prof_get(ProfStage::Busy).p99_us;
+}
+
+// 离散状态不做聚合，发送时取最新一帧
+float frame_state()
+{
+    robot_frame f;
+    return my_motion_snapshot(f) ? static_cast<float>(f.state) : 0.0f;
+}
+
+float frame_flags()
+{
+    robot_frame f;
+    if (!my_motion_snapshot(f))
+        return 0.0f;
+    return static_cast<float>((f.fallen ? WIRE_BIT_FALLEN : 0) | (f.wel_up ? WIRE_BIT_WEL_UP : 0) |
+                              (f.drv_fault ? WIRE_BIT_DRV_FAULT : 0) | (f.lowbat_warn ? WIRE_BIT_LOWBAT : 0));
+}
+
+const telem_channel channels[] = {
+    {"ang_tar", "Angle target", CHART_ANG_TAR, nullptr, nullptr},
+    {"pitch", "Angle", CHART_PITCH, nullptr, nullptr},
+    {"spd_tar", "Speed target", CHART_SPD_TAR, nullptr, nullptr},
+    {"spd_now", "Speed", CHART_SPD_NOW, nullptr, nullptr},
+    {"torque_l", "Torque L", CHART_TORQUE_L, nullptr, nullptr},
+    {"torque_r", "Torque R", CHART_TORQUE_R, nullptr, nullptr},
+    {"speed_l", "Wheel L", CHART_SPEED_L, nullptr, nullptr},
+    {"speed_r", "Wheel R", CHART_SPEED_R, nullptr, nullptr},
+    {"gyro_y", "Gyro Y", CHART_GYRO_Y, nullptr, nullptr},
+    {"acc_y", "Acc Y", CHART_ACC_Y, nullptr, nullptr},
+    {"roll", "Roll", CHART_ROLL, nullptr, nullptr},
+    {"yaw", "Yaw", CHART_YAW, nullptr, nullptr},
+    {"dzL", "Deadzone L", CHART_DZ_L, nullptr, nullptr},
+    {"dzR", "Deadzone R", CHART_DZ_R, nullptr, nullptr},
+    {"voltage", "Voltage", CHART_BATT_V, nullptr, nullptr},
+    {"battery", "Battery %", CHART_BATT_V, battery_pct, nullptr},
+    {"loop_us", "Loop us", -1, nullptr, loop_us},
+    {"loop_p99", "Loop p99 us", -1, nullptr, loop_p99},
+    {"state", "State", -1, nullptr, frame_state},
+    {"flags", "Flags", -1, nullptr, frame_flags},
+};
+constexpr uint8_t CHANNEL_COUNT = sizeof(channels) / sizeof(channels[0]);
+} // namespace
+
+uint8_t net_channel_count()
+{
+    return CHANNEL_COUNT;
+}
+
+const telem_channel &net_channel(uint8_t idx)
+{
+    return channels[idx < CHANNEL_COUNT ? idx : 0];
+}
+
+int net_channel_find(const char *name)
+{
+    for (uint8_t i = 0; i < CHANNEL_COUNT; ++i)
+    {
+        if (strcmp(channels[i].name, name) == 0)
+            return i;
+    }
+    return -1;
+}
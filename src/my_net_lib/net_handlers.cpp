@@ -1,23 +1,28 @@
-// 说明：按领域拆分的 WebSocket 指令处理器
+// 说明：按领域拆分的 WebSocket 指令处理器，经 net_cmds.h 指令表按类型哈希分发
 #include "net_handlers.h"
 #include "net_state.h"
 #include "net_persist.h"
 #include "my_motion.h"
 #include "my_motion_state.h"
 #include "my_screen.h"
+#include "my_storage.h"
 #include "my_rgb.h"
 #include "my_control.h"
-#include "my_foc.h"
-#include "my_mpu6050.h"
+#include "my_prof.h"
+#include "my_cmd.h"
+#include "net_channels.h"
+#include "net_stream.h"
 
-bool handle_auth_cmd(AsyncWebSocketClient *client, const char *type, JsonDocument &doc)
+namespace
+{
+// ---------- 认证 ----------
+
+void on_auth(AsyncWebSocketClient *client, JsonDocument &doc)
 {
-    if (strcmp(type, "auth") != 0)
-        return false;
     const char *pwd = doc["password"] | "";
     if (persist.ws_password == "" || persist.ws_password == pwd)
     {
-        // auth success handled in caller (ensure_meta set there)
+        net_client_set_authed(client->id());
         send_auth_status(client, "ok");
         send_state(client);
         send_pid(client);
@@ -31,293 +36,359 @@ bool handle_auth_cmd(AsyncWebSocketClient *client, const char *type, JsonDocumen
     {
         send_auth_status(client, "fail");
     }
-    return true;
 }
 
-bool handle_control_cmd(const char *type, JsonDocument &doc)
+// ---------- 运行控制与重启 ----------
+
+void on_robot_run(AsyncWebSocketClient *client, JsonDocument &doc)
 {
-    if (strcmp(type, "robot_run") == 0)
-    {
-        robot.run = doc["running"] | false;
-        send_state(nullptr);
-        return true;
-    }
-    if (strcmp(type, "fall_check") == 0)
-    {
-        robot.fallen.enable = doc["enable"] | true;
-        return true;
-    }
-    if (strcmp(type, "suspension_stop") == 0)
-    {
-        robot.offground_protect = doc["enable"] | true;
-        return true;
-    }
-    if (strcmp(type, "estop") == 0)
-    {
-        robot.estop = doc["active"] | false;
-        return true;
-    }
-    if (strcmp(type, "system_restart") == 0)
-    {
-        ESP.restart();
-        return true;
-    }
-    if (strcmp(type, "restart_imu") == 0)
-    {
-        my_mpu6050_init();
-        return true;
-    }
-    if (strcmp(type, "restart_motor") == 0)
-    {
-        my_motor_init();
-        return true;
-    }
-    if (strcmp(type, "calib_imu") == 0)
-    {
-        robot.imu_recalib_req = true;
-        return true;
-    }
-    if (strcmp(type, "calib_deadzone") == 0)
-    {
-        robot.run = false;
-        robot.recalib_req = true;
-        return true;
-    }
-    if (strcmp(type, "restart_wifi") == 0)
-    {
-        WiFi.disconnect(true);
-        delay(100);
-        WiFi.softAP(NET_AP_SSID, NET_AP_PASS);
-        if (!persist.wifi_ssid.isEmpty())
-            WiFi.begin(persist.wifi_ssid.c_str(), persist.wifi_pass.c_str());
-        return true;
-    }
-    return false;
+    cmd_post_flag(CmdType::Run, doc["running"] | false);
+    send_state(nullptr);
 }
 
-bool handle_freq_cmd(const char *type, JsonDocument &doc)
+void on_fall_check(AsyncWebSocketClient *client, JsonDocument &doc)
 {
-    if (strcmp(type, "telem_hz") == 0)
-    {
-        uint32_t ms = doc["ms"] | telem_ms;
-        telem_ms = ms == 0 ? 500 : ms;
-        return true;
-    }
-    if (strcmp(type, "ext_hz") == 0)
-    {
-        uint32_t ms = doc["ms"] | ext_ms;
-        ext_ms = ms == 0 ? 100 : ms;
-        return true;
-    }
-    if (strcmp(type, "attitude_send") == 0)
-    {
-        attitude_send_on = doc["on"] | true;
-        return true;
-    }
-    if (strcmp(type, "charts_send") == 0)
-    {
-        charts_send_on = doc["on"] | false;
-        return true;
-    }
-    return false;
+    cmd_post_flag(CmdType::FallCheck, doc["enable"] | true);
 }
 
-bool handle_pid_cmd(AsyncWebSocketClient *client, const char *type, JsonDocument &doc)
+void on_suspension_stop(AsyncWebSocketClient *client, JsonDocument &doc)
 {
-    if (strcmp(type, "get_pid") == 0)
-    {
-        send_pid(client);
-        return true;
-    }
-    if (strcmp(type, "set_pid") == 0)
-    {
-        JsonObject p = doc.as<JsonObject>();
-        robot.ang_pid.p = p["key01"] | robot.ang_pid.p;
-        robot.ang_pid.i = p["key02"] | robot.ang_pid.i;
-        robot.ang_pid.d = p["key03"] | robot.ang_pid.d;
-        robot.spd_pid.p = p["key04"] | robot.spd_pid.p;
-        robot.spd_pid.i = p["key05"] | robot.spd_pid.i;
-        robot.spd_pid.d = p["key06"] | robot.spd_pid.d;
-        robot.yaw_pid.p = p["key10"] | robot.yaw_pid.p;
-        robot.yaw_pid.i = p["key11"] | robot.yaw_pid.i;
-        robot.yaw_pid.d = p["key12"] | robot.yaw_pid.d;
-        send_pid(client);
-        return true;
-    }
-    if (strcmp(type, "get_pitch_zero") == 0)
-    {
-        send_pitch_zero(client);
-        return true;
-    }
-    if (strcmp(type, "pitch_zero_set") == 0)
+    cmd_post_flag(CmdType::OffgroundProtect, doc["enable"] | true);
+}
+
+void on_estop(AsyncWebSocketClient *client, JsonDocument &doc)
+{
+    cmd_post_flag(CmdType::EStop, doc["active"] | false);
+}
+
+void on_system_restart(AsyncWebSocketClient *client, JsonDocument &doc)
+{
+    storage_flush();
+    ESP.restart();
+}
+
+void on_restart_imu(AsyncWebSocketClient *client, JsonDocument &doc)
+{
+    // 重新标定要阻塞数秒，交给控制任务在周期外执行
+    cmd_post_flag(CmdType::RestartImu, true);
+}
+
+void on_restart_motor(AsyncWebSocketClient *client, JsonDocument &doc)
+{
+    cmd_post_flag(CmdType::RestartMotor, true);
+}
+
+// 丢弃对齐存档并重新扫描对齐（更换电机/磁铁后使用）
+void on_foc_realign(AsyncWebSocketClient *client, JsonDocument &doc)
+{
+    cmd_post_flag(CmdType::RealignMotor, true);
+}
+
+void on_calib_imu(AsyncWebSocketClient *client, JsonDocument &doc)
+{
+    cmd_post_flag(CmdType::CalibImu, true);
+}
+
+void on_calib_deadzone(AsyncWebSocketClient *client, JsonDocument &doc)
+{
+    cmd_post_flag(CmdType::CalibDeadzone, true);
+}
+
+void on_restart_wifi(AsyncWebSocketClient *client, JsonDocument &doc)
+{
+    WiFi.disconnect(true);
+    delay(100);
+    WiFi.softAP(NET_AP_SSID, NET_AP_PASS);
+    if (!persist.wifi_ssid.isEmpty())
+        WiFi.begin(persist.wifi_ssid.c_str(), persist.wifi_pass.c_str());
+}
+
+// ---------- 遥测频率、格式与订阅 ----------
+
+void on_telem_format(AsyncWebSocketClient *client, JsonDocument &doc)
+{
+    const char *f = doc["format"] | "json";
+    const WireFormat fmt = strcmp(f, "bin") == 0 ? WireFormat::Binary : WireFormat::Json;
+    if (client && net_client_set_format(client->id(), fmt))
+        send_telem_format(client, fmt);
+}
+
+void on_subscribe(AsyncWebSocketClient *client, JsonDocument &doc)
+{
+    // {"channels":["pitch",...],"rate_hz":20,"agg":"mean"|"minmax"}；channels 为空则取消订阅
+    if (!client)
+        return;
+    sub_request req{};
+    req.rate_hz = doc["rate_hz"] | 10.0f;
+    req.agg = strcmp(doc["agg"] | "mean", "minmax") == 0 ? SubAgg::MinMax : SubAgg::Mean;
+    for (JsonVariant v : doc["channels"].as<JsonArray>())
+    {
+        const int idx = net_channel_find(v | "");
+        if (idx >= 0 && req.n < TELEM_SUB_MAX_CH)
+            req.ch[req.n++] = static_cast<uint8_t>(idx);
+    }
+    const uint16_t decim = net_stream_subscribe(client->id(), req);
+    send_subscription(client, req, decim);
+}
+
+void on_telem_hz(AsyncWebSocketClient *client, JsonDocument &doc)
+{
+    uint32_t ms = doc["ms"] | telem_ms;
+    telem_ms = ms == 0 ? 500 : ms;
+}
+
+void on_ext_hz(AsyncWebSocketClient *client, JsonDocument &doc)
+{
+    uint32_t ms = doc["ms"] | ext_ms;
+    ext_ms = ms == 0 ? 100 : ms;
+}
+
+void on_attitude_send(AsyncWebSocketClient *client, JsonDocument &doc)
+{
+    attitude_send_on = doc["on"] | true;
+}
+
+void on_charts_send(AsyncWebSocketClient *client, JsonDocument &doc)
+{
+    charts_send_on = doc["on"] | false;
+}
+
+// ---------- PID / 零点 / 力矩限制 ----------
+
+void on_get_pid(AsyncWebSocketClient *client, JsonDocument &doc)
+{
+    send_pid(client);
+}
+
+void on_set_pid(AsyncWebSocketClient *client, JsonDocument &doc)
+{
+    // 缺省字段沿用网络侧副本（含已入队、尚未生效的修改），合并后整组入队；只有入队成功才更新副本并存档
+    JsonObject p = doc.as<JsonObject>();
+    const cmd_pid &cur = persist.pid;
+    motion_cmd c{};
+    c.type = CmdType::SetPid;
+    c.pid.ang_p = p["key01"] | cur.ang_p;
+    c.pid.ang_i = p["key02"] | cur.ang_i;
+    c.pid.ang_d = p["key03"] | cur.ang_d;
+    c.pid.spd_p = p["key04"] | cur.spd_p;
+    c.pid.spd_i = p["key05"] | cur.spd_i;
+    c.pid.spd_d = p["key06"] | cur.spd_d;
+    c.pid.yaw_p = p["key10"] | cur.yaw_p;
+    c.pid.yaw_i = p["key11"] | cur.yaw_i;
+    c.pid.yaw_d = p["key12"] | cur.yaw_d;
+    if (cmd_post(c))
+    {
+        persist.pid = c.pid;
+        storage_save_pid(c.pid);
+    }
+    send_pid(client, persist.pid);
+}
+
+void on_get_pitch_zero(AsyncWebSocketClient *client, JsonDocument &doc)
+{
+    send_pitch_zero(client);
+}
+
+void on_pitch_zero_set(AsyncWebSocketClient *client, JsonDocument &doc)
+{
+    // 缺省值取快照中的当前零点（自适应会在运行中修正它，persist 里只是上次手动设定的值）
+    robot_frame f;
+    const float cur = my_motion_snapshot(f) ? f.pitch_zero : persist.pitch_zero;
+    float v = doc["value"] | cur;
+    if (cmd_post_value(CmdType::PitchZero, v))
     {
-        float v = doc["value"] | robot.pitch_zero;
-        robot.pitch_zero = v;
+        persist.pitch_zero = v;
         net_persist_save_pitch_zero(v);
-        send_pitch_zero(client);
-        return true;
-    }
-    if (strcmp(type, "get_deadzone") == 0)
-    {
-        send_deadzone(client);
-        return true;
-    }
-    if (strcmp(type, "set_torque_limit") == 0)
-    {
-        float v = doc["value"] | torque_limit;
-        torque_limit = v;
-        return true;
     }
-    if (strcmp(type, "get_torque_limit") == 0)
-    {
-        send_torque_limit(client);
-        return true;
-    }
-    return false;
+    else
+        v = cur;
+    send_pitch_zero(client, v);
 }
 
-bool handle_motion_cmd(const char *type, JsonDocument &doc)
+void on_get_deadzone(AsyncWebSocketClient *client, JsonDocument &doc)
 {
-    if (strcmp(type, "joy") == 0)
-    {
-        robot.joy.x = doc["x"] | robot.joy.x;
-        robot.joy.y = doc["y"] | robot.joy.y;
-        robot.joy_stop_control = false;
-        return true;
-    }
-    if (strcmp(type, "test_mode") == 0)
-    {
-        bool enable = doc["enable"] | false;
-        robot.test_cmd = enable;
-        if (!enable)
-            control_reset(robot);
-        return true;
-    }
-    if (strcmp(type, "set_motor_mode") == 0)
-    {
-        const char *m = doc["mode"] | "pwm";
-        if (strcmp(m, "speed") == 0)
-            robot.motor_mode = MODE_SPEED;
-        else if (strcmp(m, "pos") == 0)
-            robot.motor_mode = MODE_POS;
-        else
-            robot.motor_mode = MODE_PWM;
-        return true;
-    }
-    if (strcmp(type, "set_motor") == 0)
-    {
-        if (robot.test_cmd)
-        {
-            robot.tor.L = doc["l"] | 0.0f;
-            robot.tor.R = doc["r"] | 0.0f;
-        }
-        return true;
-    }
-    if (strcmp(type, "set_servo") == 0)
-    {
-        StaticJsonDocument<64> resp;
-        resp["type"] = "info";
-        resp["text"] = "servo unsupported";
-        send_json(nullptr, resp);
-        return true;
-    }
-    return false;
+    send_deadzone(client);
 }
 
-bool handle_rgb_cmd(const char *type, JsonDocument &doc)
+void on_set_torque_limit(AsyncWebSocketClient *client, JsonDocument &doc)
 {
-    if (strcmp(type, "set_leds") == 0)
-    {
-        uint8_t brightness = doc["brightness"] | 255;
-        JsonArray arr = doc["leds"].as<JsonArray>();
-        std::vector<uint8_t> rgb(arr.size());
-        for (size_t i = 0; i < arr.size(); ++i)
-            rgb[i] = arr[i];
-        my_rgb_set(rgb.data(), rgb.size(), brightness);
-        return true;
-    }
-    if (strcmp(type, "set_rgb") == 0)
+    // 缺省值取快照中控制器正在使用的限幅，不直接读控制任务的全局量
+    robot_frame f;
+    const float v = doc["value"] | (my_motion_snapshot(f) ? f.torque_limit : persist.torque_limit);
+    // 入队失败（队列满）时不存档，避免存档值与控制器实际使用的值不一致
+    if (cmd_post_value(CmdType::TorqueLimit, v))
     {
-        int mode = doc["mode"] | 0;
-        int count = doc["count"] | RGB_COUNT;
-        my_rgb_preset(mode, count);
-        return true;
+        persist.torque_limit = v;
+        storage_save_torque_limit(v);
     }
-    return false;
 }
 
-bool handle_screen_cmd(const char *type, JsonDocument &doc)
+void on_get_torque_limit(AsyncWebSocketClient *client, JsonDocument &doc)
+{
+    send_torque_limit(client);
+}
+
+// ---------- 运动与测试模式 ----------
+
+void on_joy(AsyncWebSocketClient *client, JsonDocument &doc)
+{
+    // 只保留最新一帧，高频摇杆不会挤占队列
+    static float joy_x = 0.0f, joy_y = 0.0f;
+    joy_x = doc["x"] | joy_x;
+    joy_y = doc["y"] | joy_y;
+    cmd_post_joy(joy_x, joy_y);
+}
+
+void on_test_mode(AsyncWebSocketClient *client, JsonDocument &doc)
+{
+    cmd_post_flag(CmdType::TestMode, doc["enable"] | false);
+}
+
+void on_set_motor_mode(AsyncWebSocketClient *client, JsonDocument &doc)
+{
+    const char *m = doc["mode"] | "pwm";
+    motion_cmd c{};
+    c.type = CmdType::MotorMode;
+    if (strcmp(m, "speed") == 0)
+        c.mode = MODE_SPEED;
+    else if (strcmp(m, "pos") == 0)
+        c.mode = MODE_POS;
+    else
+        c.mode = MODE_PWM;
+    cmd_post(c);
+}
+
+void on_set_motor(AsyncWebSocketClient *client, JsonDocument &doc)
+{
+    // 是否处于测试模式由控制任务应用时判断，与 test_mode 指令保持先后顺序
+    motion_cmd c{};
+    c.type = CmdType::MotorOut;
+    c.out.l = doc["l"] | 0.0f;
+    c.out.r = doc["r"] | 0.0f;
+    cmd_post(c);
+}
+
+void on_set_servo(AsyncWebSocketClient *client, JsonDocument &doc)
+{
+    StaticJsonDocument<64> resp;
+    resp["type"] = "info";
+    resp["text"] = "servo unsupported";
+    send_json(nullptr, resp);
+}
+
+// ---------- RGB ----------
+
+void on_set_leds(AsyncWebSocketClient *client, JsonDocument &doc)
+{
+    uint8_t brightness = doc["brightness"] | 255;
+    JsonArray arr = doc["leds"].as<JsonArray>();
+    std::vector<uint8_t> rgb(arr.size());
+    for (size_t i = 0; i < arr.size(); ++i)
+        rgb[i] = arr[i];
+    my_rgb_set(rgb.data(), rgb.size(), brightness);
+}
+
+void on_set_rgb(AsyncWebSocketClient *client, JsonDocument &doc)
+{
+    int mode = doc["mode"] | 0;
+    int count = doc["count"] | RGB_COUNT;
+    my_rgb_preset(mode, count);
+}
+
+// ---------- 屏幕 ----------
+
+void on_screen_data_v2(AsyncWebSocketClient *client, JsonDocument &doc)
 {
-    if (strcmp(type, "screen_data_v2") != 0)
-        return false;
     uint16_t w = doc["width"] | 0;
     uint16_t h = doc["height"] | 0;
     const char *mode = doc["mode"] | "";
     const char *encoding = doc["encoding"] | "";
     if (strcmp(encoding, "base64") != 0)
-        return true;
+        return;
     String data_b64 = doc["data"] | "";
     std::vector<uint8_t> buf;
     if (decode_base64(data_b64, buf))
         my_screen_draw_buffer(buf.data(), buf.size(), w, h, mode);
-    return true;
 }
 
-bool handle_wifi_cmd(AsyncWebSocketClient *client, const char *type, JsonDocument &doc)
+// ---------- WiFi ----------
+
+void on_get_wifi_config(AsyncWebSocketClient *client, JsonDocument &doc)
 {
-    if (strcmp(type, "get_wifi_config") == 0)
-    {
-        send_wifi_config(client);
-        return true;
-    }
-    if (strcmp(type, "set_wifi_config") == 0)
-    {
-        String ssid = doc["ssid"] | "";
-        String pass = doc["password"] | "";
-        if (ssid.length() == 0)
-        {
-            send_wifi_save_status(client, "fail", "empty ssid");
-        }
-        else
-        {
-            net_persist_save_wifi(ssid, pass);
-            persist.wifi_ssid = ssid;
-            persist.wifi_pass = pass;
-            WiFi.disconnect(true);
-            delay(100);
-            WiFi.softAP(NET_AP_SSID, NET_AP_PASS);
-            if (!persist.wifi_ssid.isEmpty())
-                WiFi.begin(persist.wifi_ssid.c_str(), persist.wifi_pass.c_str());
-            send_wifi_save_status(client, "ok");
-        }
-        return true;
-    }
-    return false;
+    send_wifi_config(client);
 }
 
-bool handle_info_cmd(AsyncWebSocketClient *client, const char *type, JsonDocument &doc)
+void on_set_wifi_config(AsyncWebSocketClient *client, JsonDocument &doc)
 {
-    if (strcmp(type, "get_sys_info") == 0)
+    String ssid = doc["ssid"] | "";
+    String pass = doc["password"] | "";
+    if (ssid.length() == 0)
     {
-        send_sys_info(client);
-        return true;
+        send_wifi_save_status(client, "fail", "empty ssid");
     }
-    if (strcmp(type, "set_name") == 0)
-    {
-        String name = doc["name"] | "";
-        net_persist_save_name(name);
-        persist.robot_name = name;
-        send_sys_info(client);
-        return true;
-    }
-    if (strcmp(type, "set_password") == 0)
+    else
     {
-        String pwd = doc["password"] | "";
-        persist.ws_password = pwd;
-        net_persist_save_password(pwd);
-        send_auth_status(client, "ok");
-        send_state(nullptr);
-        return true;
+        net_persist_save_wifi(ssid, pass);
+        persist.wifi_ssid = ssid;
+        persist.wifi_pass = pass;
+        WiFi.disconnect(true);
+        delay(100);
+        WiFi.softAP(NET_AP_SSID, NET_AP_PASS);
+        if (!persist.wifi_ssid.isEmpty())
+            WiFi.begin(persist.wifi_ssid.c_str(), persist.wifi_pass.c_str());
+        send_wifi_save_status(client, "ok");
     }
-    return false;
+}
+
+// ---------- 系统信息与设置 ----------
+
+void on_get_sys_info(AsyncWebSocketClient *client, JsonDocument &doc)
+{
+    send_sys_info(client);
+}
+
+void on_get_timing(AsyncWebSocketClient *client, JsonDocument &doc)
+{
+    send_timing(client);
+}
+
+void on_get_boot(AsyncWebSocketClient *client, JsonDocument &doc)
+{
+    send_boot(client);
+}
+
+void on_timing_reset(AsyncWebSocketClient *client, JsonDocument &doc)
+{
+    prof_reset();
+    send_timing(client);
+}
+
+void on_set_name(AsyncWebSocketClient *client, JsonDocument &doc)
+{
+    String name = doc["name"] | "";
+    net_persist_save_name(name);
+    persist.robot_name = name;
+    send_sys_info(client);
+}
+
+void on_set_password(AsyncWebSocketClient *client, JsonDocument &doc)
+{
+    String pwd = doc["password"] | "";
+    persist.ws_password = pwd;
+    net_persist_save_password(pwd);
+    net_client_set_authed(client->id());
+    send_auth_status(client, "ok");
+    send_state(nullptr);
+}
+
+// 与 NET_COMMANDS 同序，下标即 NetCmdId
+#define NET_CMD_HANDLER(type, fn, flags) fn,
+const net_cmd_handler handlers[NET_CMD_COUNT] = {NET_COMMANDS(NET_CMD_HANDLER)};
+#undef NET_CMD_HANDLER
+} // namespace
+
+void net_cmd_invoke(int id, AsyncWebSocketClient *client, JsonDocument &doc)
+{
+    if (id >= 0 && id < NET_CMD_COUNT)
+        handlers[id](client, doc);
 }
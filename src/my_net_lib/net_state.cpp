@@ -1,8 +1,9 @@
-// 说明：网络全局状态与下行消息封装，含 telemetry/extended 与后台任务
+// 说明：网络全局状态、客户端登记与下行消息封装，含 telemetry/extended 与后台任务
 #include <WiFi.h>
 #include <ESPAsyncWebServer.h>
 #include <ArduinoJson.h>
 #include <mbedtls/base64.h>
+#include <atomic>
 
 #include "net_state.h"
 #include "my_motion.h"
@@ -11,6 +12,18 @@
 #include "my_screen.h"
 #include "my_rgb.h"
 #include "my_control.h"
+#include "my_prof.h"
+#include "my_acq.h"
+#include "my_i2c.h"
+#include "my_foc.h"
+#include "my_boot.h"
+#include "my_warm.h"
+#include "my_storage.h"
+#include "my_cmd.h"
+#include "net_wire.h"
+#include "my_chart.h"
+#include "net_channels.h"
+#include "net_stream.h"
 
 AsyncWebServer server(80);
 AsyncWebSocket ws("/ws");
@@ -26,15 +39,145 @@ NetPersist persist{
     .wifi_ssid = "",
     .wifi_pass = "",
     .pitch_zero = -2.1f,
+    .torque_limit = TOR_SUM_LIM,
+    .pid = {},
 };
 
 const char *NET_AP_SSID = "BalBot";
 const char *NET_AP_PASS = "balbot123";
 const char *NET_FW_VERSION = "v0.1.0";
 
-float battery_pct()
+namespace
+{
+// 已连接客户端及其遥测格式：WS 回调增删，遥测任务只读；id 为 0 表示空位
+struct client_slot
+{
+    std::atomic<uint32_t> id{0};
+    std::atomic<uint8_t> wire{static_cast<uint8_t>(WireFormat::Json)};
+    std::atomic<bool> subscribed{false}; // 已按通道订阅，不再收固定的 telemetry/extended
+    std::atomic<bool> authed{false};
+    std::atomic<uint32_t> drops{0};   // 因积压丢弃的周期帧
+    std::atomic<uint32_t> stall_ms{0}; // 开始持续积压的时刻，0 表示未积压
+};
+client_slot clients[NET_MAX_CLIENTS];
+std::atomic<uint32_t> total_drops{0};
+std::atomic<uint32_t> total_kicks{0};
+
+void count_clients(uint8_t &n_json, uint8_t &n_bin)
+{
+    n_json = n_bin = 0;
+    for (const client_slot &c : clients)
+    {
+        if (c.id.load(std::memory_order_acquire) == 0 || c.subscribed.load(std::memory_order_relaxed))
+            continue;
+        if (c.wire.load(std::memory_order_relaxed) == static_cast<uint8_t>(WireFormat::Binary))
+            n_bin++;
+        else
+            n_json++;
+    }
+}
+
+// 每种格式只编码一次，再按客户端协商结果分发同一份缓冲
+void send_by_format(AsyncWebSocketMessageBuffer *json, AsyncWebSocketMessageBuffer *bin)
+{
+    for (const client_slot &c : clients)
+    {
+        const uint32_t id = c.id.load(std::memory_order_acquire);
+        if (id == 0 || c.subscribed.load(std::memory_order_relaxed))
+            continue;
+        const bool is_bin = c.wire.load(std::memory_order_relaxed) == static_cast<uint8_t>(WireFormat::Binary);
+        net_send_stream(id, is_bin ? bin : json, is_bin);
+    }
+}
+
+void fill_header(wire_header &h, WireKind kind, uint8_t size, const robot_frame &f)
+{
+    h.magic = NET_WIRE_MAGIC;
+    h.version = NET_WIRE_VERSION;
+    h.kind = static_cast<uint8_t>(kind);
+    h.size = size;
+    h.seq = f.seq;
+    h.t_ms = f.t_ms;
+}
+} // namespace
+
+void net_client_add(uint32_t id)
+{
+    for (client_slot &c : clients)
+    {
+        uint32_t empty = 0;
+        if (c.id.compare_exchange_strong(empty, id, std::memory_order_acq_rel))
+            return;
+    }
+}
+
+void net_client_remove(uint32_t id)
+{
+    for (client_slot &c : clients)
+    {
+        if (c.id.load(std::memory_order_acquire) != id)
+            continue;
+        // 先复位格式与订阅再腾出空位，新客户端接手时一定是默认 JSON 遥测
+        c.wire.store(static_cast<uint8_t>(WireFormat::Json), std::memory_order_relaxed);
+        c.subscribed.store(false, std::memory_order_relaxed);
+        c.authed.store(false, std::memory_order_relaxed);
+        c.drops.store(0, std::memory_order_relaxed);
+        c.stall_ms.store(0, std::memory_order_relaxed);
+        c.id.store(0, std::memory_order_release);
+        return;
+    }
+}
+
+int net_client_slot(uint32_t id)
+{
+    for (uint8_t i = 0; i < NET_MAX_CLIENTS; ++i)
+    {
+        if (id != 0 && clients[i].id.load(std::memory_order_acquire) == id)
+            return i;
+    }
+    return -1;
+}
+
+uint32_t net_client_at(uint8_t slot, WireFormat &fmt, bool &subscribed)
+{
+    const client_slot &c = clients[slot];
+    fmt = static_cast<WireFormat>(c.wire.load(std::memory_order_relaxed));
+    subscribed = c.subscribed.load(std::memory_order_relaxed);
+    return c.id.load(std::memory_order_acquire);
+}
+
+void net_client_set_authed(uint32_t id)
+{
+    const int slot = net_client_slot(id);
+    if (slot >= 0)
+        clients[slot].authed.store(true, std::memory_order_relaxed);
+}
+
+bool net_client_authed(uint32_t id)
+{
+    const int slot = net_client_slot(id);
+    return slot >= 0 && clients[slot].authed.load(std::memory_order_relaxed);
+}
+
+void net_client_set_subscribed(uint8_t slot, bool on)
+{
+    clients[slot].subscribed.store(on, std::memory_order_relaxed);
+}
+
+bool net_client_set_format(uint32_t id, WireFormat fmt)
+{
+    for (client_slot &c : clients)
+    {
+        if (c.id.load(std::memory_order_acquire) != id)
+            continue;
+        c.wire.store(static_cast<uint8_t>(fmt), std::memory_order_relaxed);
+        return true;
+    }
+    return false;
+}
+
+float battery_pct(float v)
 {
-    float v = battery_voltage;
     if (v < BAT_PCT_MIN_V)
         return 0.0f;
     if (v > BAT_PCT_MAX_V)
@@ -68,14 +211,93 @@ String current_ip()
     return "0.0.0.0";
 }
 
+AsyncWebSocketMessageBuffer *net_json_buffer(const JsonDocument &doc)
+{
+    const size_t len = measureJson(doc);
+    AsyncWebSocketMessageBuffer *buf = ws.makeBuffer(len); // 内部多分配 1 字节结尾
+    if (!buf)
+        return nullptr;
+    serializeJson(doc, reinterpret_cast<char *>(buf->get()), len + 1);
+    buf->lock();
+    return buf;
+}
+
+AsyncWebSocketMessageBuffer *net_bin_buffer(size_t len)
+{
+    AsyncWebSocketMessageBuffer *buf = ws.makeBuffer(len);
+    if (buf)
+        buf->lock();
+    return buf;
+}
+
+void net_send_buffer(uint32_t id, AsyncWebSocketMessageBuffer *buf, bool binary)
+{
+    if (!buf)
+        return;
+    AsyncWebSocketClient *c = ws.client(id);
+    if (!c)
+        return;
+    if (binary)
+        c->binary(buf);
+    else
+        c->text(buf);
+}
+
+bool net_send_stream(uint32_t id, AsyncWebSocketMessageBuffer *buf, bool binary)
+{
+    if (!buf)
+        return false;
+    const int slot = net_client_slot(id);
+    AsyncWebSocketClient *c = ws.client(id);
+    if (slot < 0 || !c)
+        return false;
+    client_slot &cs = clients[slot];
+
+    // 积压时丢掉本帧而不是排在陈旧帧后面；队列排空后客户端直接拿到最新一帧
+    if (c->queueLen() >= NET_CLIENT_QUEUE_SOFT || c->queueIsFull())
+    {
+        cs.drops.fetch_add(1, std::memory_order_relaxed);
+        total_drops.fetch_add(1, std::memory_order_relaxed);
+        const uint32_t now = millis();
+        uint32_t since = cs.stall_ms.load(std::memory_order_relaxed);
+        if (since == 0)
+            cs.stall_ms.store(now ? now : 1, std::memory_order_relaxed);
+        else if (now - since > NET_CLIENT_STALL_MS)
+        {
+            // 长时间不消费的客户端直接断开，释放其队列占用的内存
+            cs.stall_ms.store(0, std::memory_order_relaxed);
+            total_kicks.fetch_add(1, std::memory_order_relaxed);
+            c->close();
+        }
+        return false;
+    }
+    cs.stall_ms.store(0, std::memory_order_relaxed);
+    if (binary)
+        c->binary(buf);
+    else
+        c->text(buf);
+    return true;
+}
+
+void net_release_buffer(AsyncWebSocketMessageBuffer *buf)
+{
+    if (!buf)
+        return;
+    // 各客户端队列各自持有引用，全部发完后由 _cleanBuffers 回收
+    buf->unlock();
+    ws._cleanBuffers();
+}
+
 void send_json(AsyncWebSocketClient *client, const JsonDocument &doc)
 {
-    String out;
-    serializeJson(doc, out);
+    AsyncWebSocketMessageBuffer *buf = net_json_buffer(doc);
+    if (!buf)
+        return;
     if (client)
-        client->text(out);
+        client->text(buf);
     else
-        ws.textAll(out);
+        ws.textAll(buf);
+    net_release_buffer(buf);
 }
 
 void send_state(AsyncWebSocketClient *client)
@@ -85,10 +307,15 @@ void send_state(AsyncWebSocketClient *client)
     doc["auth_required"] = !persist.ws_password.isEmpty();
     doc["name"] = persist.robot_name;
     doc["fw_version"] = NET_FW_VERSION;
+    doc["wire_version"] = NET_WIRE_VERSION;
     doc["ip"] = current_ip();
-    doc["battery"] = battery_pct();
-    doc["voltage"] = battery_voltage;
-    doc["state"] = motion_state_name(robot.state);
+    robot_frame f;
+    if (my_motion_snapshot(f))
+    {
+        doc["battery"] = battery_pct(f.batt_v);
+        doc["voltage"] = f.batt_v;
+        doc["state"] = motion_state_name(f.state);
+    }
     send_json(client, doc);
 }
 
@@ -138,116 +365,340 @@ void send_wifi_save_status(AsyncWebSocketClient *client, const char *status, con
 }
 
 void send_pid(AsyncWebSocketClient *client)
+{
+    send_pid(client, persist.pid);
+}
+
+void send_pid(AsyncWebSocketClient *client, const cmd_pid &v)
 {
     if (!client)
         return;
     StaticJsonDocument<256> doc;
     doc["type"] = "pid";
     JsonObject p = doc.createNestedObject("param");
-    p["key01"] = robot.ang_pid.p;
-    p["key02"] = robot.ang_pid.i;
-    p["key03"] = robot.ang_pid.d;
-    p["key04"] = robot.spd_pid.p;
-    p["key05"] = robot.spd_pid.i;
-    p["key06"] = robot.spd_pid.d;
+    p["key01"] = v.ang_p;
+    p["key02"] = v.ang_i;
+    p["key03"] = v.ang_d;
+    p["key04"] = v.spd_p;
+    p["key05"] = v.spd_i;
+    p["key06"] = v.spd_d;
     p["key07"] = 0.0f;
     p["key08"] = 0.0f;
     p["key09"] = 0.0f;
-    p["key10"] = robot.yaw_pid.p;
-    p["key11"] = robot.yaw_pid.i;
-    p["key12"] = robot.yaw_pid.d;
+    p["key10"] = v.yaw_p;
+    p["key11"] = v.yaw_i;
+    p["key12"] = v.yaw_d;
     send_json(client, doc);
 }
 
 void send_pitch_zero(AsyncWebSocketClient *client)
+{
+    robot_frame f;
+    send_pitch_zero(client, my_motion_snapshot(f) ? f.pitch_zero : persist.pitch_zero);
+}
+
+void send_pitch_zero(AsyncWebSocketClient *client, float value)
 {
     if (!client)
         return;
     StaticJsonDocument<96> doc;
     doc["type"] = "pitch_zero_state";
-    doc["value"] = robot.pitch_zero;
+    doc["value"] = value;
     send_json(client, doc);
 }
 
+uint32_t net_period_us()
+{
+    robot_frame f;
+    return my_motion_snapshot(f) ? f.dt_us : CONTROL_PERIOD_US;
+}
+
 void send_torque_limit(AsyncWebSocketClient *client)
 {
     if (!client)
         return;
     StaticJsonDocument<96> doc;
     doc["type"] = "torque_limit_state";
-    doc["value"] = torque_limit;
+    robot_frame f;
+    doc["value"] = my_motion_snapshot(f) ? f.torque_limit : persist.torque_limit;
     send_json(client, doc);
 }
 
 void send_deadzone(AsyncWebSocketClient *client)
 {
+    // 死区由控制任务标定，只从快照读；尚未发布第一帧时不回显
+    robot_frame f;
+    if (!my_motion_snapshot(f))
+        return;
     StaticJsonDocument<128> doc;
     doc["type"] = "deadzone";
-    doc["dzL"] = robot.tor.dzL;
-    doc["dzR"] = robot.tor.dzR;
+    doc["dzL"] = f.dzL;
+    doc["dzR"] = f.dzR;
     send_json(client, doc);
 }
 
 void send_schema(AsyncWebSocketClient *client)
 {
-    StaticJsonDocument<256> doc;
+    StaticJsonDocument<768> doc;
     doc["type"] = "schema";
     JsonObject s = doc.createNestedObject("schema");
-    s["ang_tar"] = "Angle target";
-    s["pitch"] = "Angle";
-    s["spd_tar"] = "Speed target";
-    s["spd_now"] = "Speed";
-    s["torque_l"] = "Torque L";
-    s["torque_r"] = "Torque R";
-    s["speed_l"] = "Wheel L";
-    s["speed_r"] = "Wheel R";
-    s["gyro_y"] = "Gyro Y";
-    s["acc_y"] = "Acc Y";
-    s["battery"] = "Battery %";
+    for (uint8_t i = 0; i < net_channel_count(); ++i)
+    {
+        const telem_channel &ch = net_channel(i);
+        s[ch.name] = ch.label;
+    }
+    send_json(client, doc);
+}
+
+void send_subscription(AsyncWebSocketClient *client, const sub_request &req, uint16_t decim)
+{
+    if (!client)
+        return;
+    StaticJsonDocument<768> doc;
+    doc["type"] = "subscribed";
+    doc["active"] = decim > 0;
+    if (decim > 0)
+    {
+        JsonArray ch = doc.createNestedArray("channels");
+        for (uint8_t i = 0; i < req.n; ++i)
+            ch.add(net_channel(req.ch[i]).name);
+        doc["decim"] = decim;
+        doc["rate_hz"] = 1e6f / (decim * net_period_us());
+        doc["agg"] = req.agg == SubAgg::MinMax ? "minmax" : "mean";
+    }
+    send_json(client, doc);
+}
+
+// 启动时间线：各阶段上电后的起止 ms，未开始/未结束为 0
+void send_boot(AsyncWebSocketClient *client)
+{
+    if (!client)
+        return;
+    StaticJsonDocument<512> doc;
+    doc["type"] = "boot";
+    doc["warm"] = warm_booted();
+    JsonObject st = doc.createNestedObject("stages");
+    for (uint8_t i = 0; i < static_cast<uint8_t>(BootStage::Count); ++i)
+    {
+        const BootStage stage = static_cast<BootStage>(i);
+        const boot_span b = boot_get(stage);
+        JsonArray a = st.createNestedArray(boot_stage_name(stage));
+        a.add(b.start_ms);
+        a.add(b.end_ms);
+    }
+    send_json(client, doc);
+}
+
+void send_timing(AsyncWebSocketClient *client)
+{
+    if (!client)
+        return;
+    StaticJsonDocument<2304> doc;
+    doc["type"] = "timing";
+    doc["budget_us"] = net_period_us();
+    doc["overruns"] = prof_overruns();
+    doc["bin_us"] = PROF_BIN_US;
+    doc["acq_frames"] = my_acq_frames();
+    doc["acq_misses"] = my_acq_misses();
+    doc["acq_lead_us"] = my_acq_lead_us();
+    doc["acq_wait_us"] = my_acq_wait_us();
+    doc["cmd_applied"] = cmd_applied();
+    doc["cmd_dropped"] = cmd_dropped();
+    doc["ws_drops"] = total_drops.load(std::memory_order_relaxed);
+    doc["ws_kicks"] = total_kicks.load(std::memory_order_relaxed);
+    doc["oled_bytes"] = my_screen_tx_bytes();
+    const foc_stats fs = my_foc_get_stats();
+    JsonObject foc = doc.createNestedObject("foc");
+    foc["target_hz"] = FOC_LOOP_US ? 1000000U / FOC_LOOP_US : 0;
+    foc["hz"] = fs.rate_hz;
+    foc["loops"] = fs.loops;
+    foc["overruns"] = fs.overruns;
+    foc["busy_us"] = fs.busy_us;
+    foc["max_us"] = fs.max_busy_us;
+    const storage_stats ss = storage_get_stats();
+    JsonObject nvs = doc.createNestedObject("nvs");
+    nvs["origin"] = storage_origin_name(ss.origin);
+    nvs["load_us"] = ss.load_us;
+    nvs["commits"] = ss.commits;
+    nvs["bytes"] = ss.bytes_written;
+    nvs["failures"] = ss.failures;
+    nvs["pending"] = ss.pending;
+    nvs["last_us"] = ss.last_commit_us;
+    nvs["max_us"] = ss.max_commit_us;
+    JsonObject bus = doc.createNestedObject("i2c1_wait");
+    for (uint8_t i = 0; i < static_cast<uint8_t>(I2cDev::Count); ++i)
+    {
+        const I2cDev dev = static_cast<I2cDev>(i);
+        const i2c_wait_stats w = i2c1_wait_stats(dev);
+        JsonObject o = bus.createNestedObject(i2c_dev_name(dev));
+        o["n"] = w.n;
+        o["avg"] = w.avg_us;
+        o["max"] = w.max_us;
+    }
+    JsonArray cl = doc.createNestedArray("clients");
+    for (const client_slot &c : clients)
+    {
+        const uint32_t id = c.id.load(std::memory_order_acquire);
+        if (id == 0)
+            continue;
+        JsonObject o = cl.createNestedObject();
+        o["id"] = id;
+        AsyncWebSocketClient *wc = ws.client(id);
+        o["queue"] = wc ? wc->queueLen() : 0;
+        o["drops"] = c.drops.load(std::memory_order_relaxed);
+    }
+    JsonObject st = doc.createNestedObject("stages");
+    for (uint8_t i = 0; i < static_cast<uint8_t>(ProfStage::Count); ++i)
+    {
+        const ProfStage stage = static_cast<ProfStage>(i);
+        const prof_summary p = prof_get(stage);
+        JsonObject o = st.createNestedObject(prof_stage_name(stage));
+        o["n"] = p.count;
+        o["last"] = p.last_us;
+        o["min"] = p.min_us;
+        o["max"] = p.max_us;
+        o["avg"] = p.avg_us;
+        o["p50"] = p.p50_us;
+        o["p99"] = p.p99_us;
+    }
     send_json(client, doc);
 }
 
+// 遥测只读控制任务发布的快照，保证同一条消息内各字段来自同一周期
 void broadcast_telemetry()
 {
-    StaticJsonDocument<384> doc;
-    doc["type"] = "telemetry";
-    doc["pitch"] = robot.ang.now;
-    doc["roll"] = robot.imu.anglex;
-    doc["yaw"] = robot.yaw.now;
-    doc["fallen"] = robot.fallen.is;
-    doc["battery"] = battery_pct();
-    doc["voltage"] = battery_voltage;
-    doc["state"] = motion_state_name(robot.state);
-    doc["wel_up"] = robot.wel_up;
-    doc["drv_fault"] = robot.drv_fault;
-    doc["speed_l"] = robot.wL;
-    doc["speed_r"] = robot.wR;
-    doc["torque_l"] = robot.tor.L;
-    doc["torque_r"] = robot.tor.R;
-    doc["dzL"] = robot.tor.dzL;
-    doc["dzR"] = robot.tor.dzR;
-    send_json(nullptr, doc);
+    uint8_t n_json, n_bin;
+    count_clients(n_json, n_bin);
+    if (n_json + n_bin == 0)
+        return;
+    robot_frame f;
+    if (!my_motion_snapshot(f))
+        return;
+
+    AsyncWebSocketMessageBuffer *json = nullptr;
+    if (n_json)
+    {
+        StaticJsonDocument<384> doc;
+        doc["type"] = "telemetry";
+        doc["pitch"] = f.pitch;
+        doc["roll"] = f.roll;
+        doc["yaw"] = f.yaw;
+        doc["fallen"] = f.fallen;
+        doc["battery"] = battery_pct(f.batt_v);
+        doc["voltage"] = f.batt_v;
+        doc["state"] = motion_state_name(f.state);
+        doc["wel_up"] = f.wel_up;
+        doc["drv_fault"] = f.drv_fault;
+        doc["speed_l"] = f.wL;
+        doc["speed_r"] = f.wR;
+        doc["torque_l"] = f.tor_L;
+        doc["torque_r"] = f.tor_R;
+        doc["dzL"] = f.dzL;
+        doc["dzR"] = f.dzR;
+        json = net_json_buffer(doc);
+    }
+
+    AsyncWebSocketMessageBuffer *bin = n_bin ? net_bin_buffer(sizeof(wire_telemetry)) : nullptr;
+    if (bin)
+    {
+        wire_telemetry &w = *reinterpret_cast<wire_telemetry *>(bin->get());
+        w = wire_telemetry{};
+        fill_header(w.h, WireKind::Telemetry, sizeof(w), f);
+        w.state = static_cast<uint8_t>(f.state);
+        w.bits = (f.fallen ? WIRE_BIT_FALLEN : 0) | (f.wel_up ? WIRE_BIT_WEL_UP : 0) |
+                 (f.drv_fault ? WIRE_BIT_DRV_FAULT : 0) | (f.lowbat_warn ? WIRE_BIT_LOWBAT : 0);
+        w.pitch = f.pitch;
+        w.roll = f.roll;
+        w.yaw = f.yaw;
+        w.battery = battery_pct(f.batt_v);
+        w.voltage = f.batt_v;
+        w.speed_l = f.wL;
+        w.speed_r = f.wR;
+        w.torque_l = f.tor_L;
+        w.torque_r = f.tor_R;
+        w.dzL = f.dzL;
+        w.dzR = f.dzR;
+    }
+    send_by_format(json, bin);
+    net_release_buffer(json);
+    net_release_buffer(bin);
 }
 
 void broadcast_extended()
 {
     if (!charts_send_on)
         return;
+    uint8_t n_json, n_bin;
+    count_clients(n_json, n_bin);
+    if (n_json + n_bin == 0)
+        return;
+    robot_frame f;
+    if (!my_motion_snapshot(f))
+        return;
+    const prof_summary busy = prof_get(ProfStage::Busy);
+
+    AsyncWebSocketMessageBuffer *json = nullptr;
+    if (n_json)
+    {
+        StaticJsonDocument<512> doc;
+        doc["type"] = "extended";
+        JsonObject d = doc.createNestedObject("data");
+        d["ang_tar"] = f.ang_tar;
+        d["pitch"] = f.pitch;
+        d["spd_tar"] = f.spd_tar;
+        d["spd_now"] = f.spd_now;
+        d["torque_l"] = f.tor_L;
+        d["torque_r"] = f.tor_R;
+        d["speed_l"] = f.wL;
+        d["speed_r"] = f.wR;
+        d["gyro_y"] = f.gyro_y;
+        d["acc_y"] = f.pitch_raw;
+        d["battery"] = battery_pct(f.batt_v);
+        d["loop_us"] = busy.last_us;
+        d["loop_p99"] = busy.p99_us;
+        d["overruns"] = prof_overruns();
+        json = net_json_buffer(doc);
+    }
+
+    AsyncWebSocketMessageBuffer *bin = n_bin ? net_bin_buffer(sizeof(wire_extended)) : nullptr;
+    if (bin)
+    {
+        wire_extended &w = *reinterpret_cast<wire_extended *>(bin->get());
+        w = wire_extended{};
+        fill_header(w.h, WireKind::Extended, sizeof(w), f);
+        w.ang_tar = f.ang_tar;
+        w.pitch = f.pitch;
+        w.spd_tar = f.spd_tar;
+        w.spd_now = f.spd_now;
+        w.torque_l = f.tor_L;
+        w.torque_r = f.tor_R;
+        w.speed_l = f.wL;
+        w.speed_r = f.wR;
+        w.gyro_y = f.gyro_y;
+        w.acc_y = f.pitch_raw;
+        w.battery = battery_pct(f.batt_v);
+        w.loop_us = busy.last_us;
+        w.loop_p99 = busy.p99_us;
+        w.overruns = prof_overruns();
+    }
+    send_by_format(json, bin);
+    net_release_buffer(json);
+    net_release_buffer(bin);
+}
+
+void send_telem_format(AsyncWebSocketClient *client, WireFormat fmt)
+{
+    if (!client)
+        return;
     StaticJsonDocument<384> doc;
-    doc["type"] = "extended";
-    JsonObject d = doc.createNestedObject("data");
-    d["ang_tar"] = robot.ang.tar;
-    d["pitch"] = robot.ang.now;
-    d["spd_tar"] = robot.spd.tar;
-    d["spd_now"] = robot.spd.now;
-    d["torque_l"] = robot.tor.L;
-    d["torque_r"] = robot.tor.R;
-    d["speed_l"] = robot.wL;
-    d["speed_r"] = robot.wR;
-    d["gyro_y"] = robot.imu.gyroy;
-    d["acc_y"] = robot.imu.angley;
-    d["battery"] = battery_pct();
-    send_json(nullptr, doc);
+    doc["type"] = "telem_format";
+    doc["format"] = fmt == WireFormat::Binary ? "bin" : "json";
+    doc["version"] = NET_WIRE_VERSION;
+    doc["magic"] = NET_WIRE_MAGIC;
+    JsonArray ch = doc.createNestedArray("chart_channels");
+    for (uint8_t i = 0; i < CHART_PLOT_CHANNELS; ++i)
+        ch.add(chart_channel_name(i));
+    send_json(client, doc);
 }
 
 bool decode_base64(const String &in, std::vector<uint8_t> &out)
@@ -272,6 +723,8 @@ void telem_task(void *)
     {
         if (attitude_send_on)
             broadcast_telemetry();
+        // 回收已断开的客户端，超出上限时关闭最早的连接
+        ws.cleanupClients(NET_MAX_CLIENTS);
         vTaskDelayUntil(&last, pdMS_TO_TICKS(telem_ms));
     }
 }
@@ -292,4 +745,5 @@ void net_start_tasks()
     static TaskHandle_t ext_handle = nullptr;
     xTaskCreatePinnedToCore(telem_task, "telem", 4096, nullptr, 1, &telem_handle, 1);
     xTaskCreatePinnedToCore(ext_task, "ext", 4096, nullptr, 1, &ext_handle, 1);
+    net_stream_start();
 }
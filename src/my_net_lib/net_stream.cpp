@@ -0,0 +1,337 @@
+// 说明：全速率遥测分发任务，负责曲线批量帧与按客户端订阅的抽取/聚合
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <float.h>
+
+#include "net_stream.h"
+#include "net_state.h"
+#include "net_channels.h"
+#include "net_wire.h"
+#include "my_chart.h"
+#include "my_motion.h"
+#include "my_seqlock.h"
+
+namespace
+{
+// WS 回调写、分发任务读的订阅配置；id 用于识别槽位是否已换了客户端
+struct sub_config
+{
+    uint32_t id;
+    uint8_t n;
+    uint8_t ch[TELEM_SUB_MAX_CH];
+    uint16_t decim;
+    SubAgg agg;
+};
+
+// 以下仅分发任务访问
+struct sub_acc
+{
+    uint32_t seen;
+    sub_config cfg;
+    uint16_t count;
+    uint32_t seq0;
+    uint32_t t0;
+    float sum[TELEM_SUB_MAX_CH];
+    float mn[TELEM_SUB_MAX_CH];
+    float mx[TELEM_SUB_MAX_CH];
+};
+
+seqlock<sub_config> sub_slot[NET_MAX_CLIENTS];
+sub_acc acc[NET_MAX_CLIENTS];
+
+chart_sample staged[CHART_BATCH]; // 待打包的曲线样本
+size_t n_staged = 0;
+
+void acc_reset(sub_acc &a)
+{
+    a.count = 0;
+    for (uint8_t i = 0; i < TELEM_SUB_MAX_CH; ++i)
+    {
+        a.sum[i] = 0.0f;
+        a.mn[i] = FLT_MAX;
+        a.mx[i] = -FLT_MAX;
+    }
+}
+
+// 取最新订阅配置，返回该槽位是否有效
+bool sync_config(uint8_t slot)
+{
+    sub_acc &a = acc[slot];
+    const uint32_t v = sub_slot[slot].version();
+    if (v != a.seen)
+    {
+        sub_config cfg;
+        if (sub_slot[slot].try_load(cfg))
+        {
+            a.seen = v;
+            a.cfg = cfg;
+            acc_reset(a);
+        }
+    }
+    return a.cfg.n > 0;
+}
+
+void emit(uint8_t slot, sub_acc &a)
+{
+    WireFormat fmt;
+    bool subscribed;
+    const uint32_t id = net_client_at(slot, fmt, subscribed);
+    if (id == 0 || id != a.cfg.id)
+        return;
+
+    float mean[TELEM_SUB_MAX_CH], mn[TELEM_SUB_MAX_CH], mx[TELEM_SUB_MAX_CH];
+    for (uint8_t i = 0; i < a.cfg.n; ++i)
+    {
+        const telem_channel &ch = net_channel(a.cfg.ch[i]);
+        if (ch.col < 0)
+        {
+            mean[i] = mn[i] = mx[i] = ch.read();
+            continue;
+        }
+        mean[i] = a.sum[i] / a.count;
+        mn[i] = a.mn[i];
+        mx[i] = a.mx[i];
+        if (ch.xform)
+        {
+            mean[i] = ch.xform(mean[i]);
+            mn[i] = ch.xform(mn[i]);
+            mx[i] = ch.xform(mx[i]);
+        }
+    }
+    const bool minmax = a.cfg.agg == SubAgg::MinMax;
+
+    if (fmt == WireFormat::Binary)
+    {
+        const size_t len = sizeof(wire_subscription) + a.cfg.n * (minmax ? 3 : 1) * sizeof(float);
+        AsyncWebSocketMessageBuffer *buf = net_bin_buffer(len);
+        if (!buf)
+            return;
+        wire_subscription *w = reinterpret_cast<wire_subscription *>(buf->get());
+        w->h.magic = NET_WIRE_MAGIC;
+        w->h.version = NET_WIRE_VERSION;
+        w->h.kind = static_cast<uint8_t>(WireKind::Subscription);
+        w->h.size = sizeof(wire_subscription);
+        w->h.seq = a.seq0;
+        w->h.t_ms = a.t0;
+        w->count = a.count;
+        w->channels = a.cfg.n;
+        w->agg = static_cast<uint8_t>(a.cfg.agg);
+        float *v = reinterpret_cast<float *>(buf->get() + sizeof(wire_subscription));
+        for (uint8_t i = 0; i < a.cfg.n; ++i)
+        {
+            *v++ = mean[i];
+            if (minmax)
+            {
+                *v++ = mn[i];
+                *v++ = mx[i];
+            }
+        }
+        net_send_stream(id, buf, true);
+        net_release_buffer(buf);
+        return;
+    }
+
+    StaticJsonDocument<1536> doc;
+    doc["type"] = "sub";
+    doc["seq"] = a.seq0;
+    doc["t_ms"] = a.t0;
+    doc["n"] = a.count;
+    JsonObject d = doc.createNestedObject("data");
+    for (uint8_t i = 0; i < a.cfg.n; ++i)
+    {
+        const char *name = net_channel(a.cfg.ch[i]).name;
+        if (minmax)
+        {
+            JsonArray arr = d.createNestedArray(name);
+            arr.add(mean[i]);
+            arr.add(mn[i]);
+            arr.add(mx[i]);
+        }
+        else
+        {
+            d[name] = mean[i];
+        }
+    }
+    AsyncWebSocketMessageBuffer *buf = net_json_buffer(doc);
+    net_send_stream(id, buf, false);
+    net_release_buffer(buf);
+}
+
+void feed_subscriptions(const chart_sample *s, size_t n, bool active[NET_MAX_CLIENTS])
+{
+    for (uint8_t slot = 0; slot < NET_MAX_CLIENTS; ++slot)
+    {
+        if (!active[slot])
+            continue;
+        sub_acc &a = acc[slot];
+        for (size_t k = 0; k < n; ++k)
+        {
+            if (a.count == 0)
+            {
+                a.seq0 = s[k].seq;
+                a.t0 = s[k].t_ms;
+            }
+            for (uint8_t i = 0; i < a.cfg.n; ++i)
+            {
+                const int8_t col = net_channel(a.cfg.ch[i]).col;
+                if (col < 0)
+                    continue;
+                const float v = s[k].v[col];
+                a.sum[i] += v;
+                if (v < a.mn[i])
+                    a.mn[i] = v;
+                if (v > a.mx[i])
+                    a.mx[i] = v;
+            }
+            if (++a.count >= a.cfg.decim)
+            {
+                emit(slot, a);
+                acc_reset(a);
+            }
+        }
+    }
+}
+
+// 曲线批量帧发给未订阅的二进制客户端
+void flush_chart_batch()
+{
+    if (n_staged == 0)
+        return;
+    // 一批只编码一次，所有订阅曲线的客户端共享同一份缓冲
+    AsyncWebSocketMessageBuffer *buf =
+        net_bin_buffer(sizeof(wire_chart_batch) + CHART_PLOT_CHANNELS * n_staged * sizeof(float));
+    if (!buf)
+    {
+        n_staged = 0;
+        return;
+    }
+    wire_chart_batch *b = reinterpret_cast<wire_chart_batch *>(buf->get());
+    b->h.magic = NET_WIRE_MAGIC;
+    b->h.version = NET_WIRE_VERSION;
+    b->h.kind = static_cast<uint8_t>(WireKind::ChartBatch);
+    b->h.size = sizeof(wire_chart_batch);
+    b->h.seq = staged[0].seq;
+    b->h.t_ms = staged[0].t_ms;
+    b->period_us = net_period_us();
+    b->count = static_cast<uint16_t>(n_staged);
+    b->channels = CHART_PLOT_CHANNELS;
+    b->reserved = 0;
+    b->overflows = chart_overflows();
+
+    // 行转列：同一通道连续存放，客户端可直接映射为 Float32Array
+    float *col = reinterpret_cast<float *>(buf->get() + sizeof(wire_chart_batch));
+    for (uint8_t ch = 0; ch < CHART_PLOT_CHANNELS; ++ch)
+        for (size_t i = 0; i < n_staged; ++i)
+            *col++ = staged[i].v[ch];
+
+    for (uint8_t slot = 0; slot < NET_MAX_CLIENTS; ++slot)
+    {
+        WireFormat fmt;
+        bool subscribed;
+        const uint32_t id = net_client_at(slot, fmt, subscribed);
+        if (id != 0 && fmt == WireFormat::Binary && !subscribed)
+            net_send_stream(id, buf, true);
+    }
+    net_release_buffer(buf);
+    n_staged = 0;
+}
+
+// 攒满 CHART_BATCH 个序号连续的样本再发，帧数与样本率解耦
+void feed_chart(const chart_sample *s, size_t n)
+{
+    for (size_t k = 0; k < n; ++k)
+    {
+        if (n_staged > 0 && s[k].seq != staged[n_staged - 1].seq + 1)
+            flush_chart_batch();
+        staged[n_staged++] = s[k];
+        if (n_staged == CHART_BATCH)
+            flush_chart_batch();
+    }
+}
+
+bool chart_wanted()
+{
+    if (!charts_send_on)
+        return false;
+    for (uint8_t slot = 0; slot < NET_MAX_CLIENTS; ++slot)
+    {
+        WireFormat fmt;
+        bool subscribed;
+        if (net_client_at(slot, fmt, subscribed) != 0 && fmt == WireFormat::Binary && !subscribed)
+            return true;
+    }
+    return false;
+}
+
+void stream_task(void *)
+{
+    static chart_sample samples[CHART_BATCH];
+    TickType_t last = xTaskGetTickCount();
+    for (;;)
+    {
+        bool active[NET_MAX_CLIENTS];
+        bool any_sub = false;
+        for (uint8_t slot = 0; slot < NET_MAX_CLIENTS; ++slot)
+            any_sub |= active[slot] = sync_config(slot);
+        const bool chart = chart_wanted();
+
+        chart_capture_enable(any_sub || chart);
+        if (!chart)
+            n_staged = 0;
+
+        size_t n;
+        while (chart_capture_enabled() && (n = chart_pop(samples, CHART_BATCH)) > 0)
+        {
+            if (chart)
+                feed_chart(samples, n);
+            feed_subscriptions(samples, n, active);
+        }
+        vTaskDelayUntil(&last, pdMS_TO_TICKS(TELEM_STREAM_MS));
+    }
+}
+} // namespace
+
+uint16_t net_stream_subscribe(uint32_t client_id, const sub_request &req)
+{
+    const int slot = net_client_slot(client_id);
+    if (slot < 0)
+        return 0;
+
+    sub_config cfg{};
+    cfg.id = client_id;
+    cfg.agg = req.agg;
+    for (uint8_t i = 0; i < req.n && i < TELEM_SUB_MAX_CH; ++i)
+    {
+        if (req.ch[i] < net_channel_count())
+            cfg.ch[cfg.n++] = req.ch[i];
+    }
+    if (cfg.n == 0 || req.rate_hz <= 0.0f)
+    {
+        net_stream_unsubscribe(client_id);
+        return 0;
+    }
+    // 以控制周期为单位抽取：1 表示全速率
+    const float per_cycle = 1e6f / (req.rate_hz * net_period_us());
+    cfg.decim = per_cycle < 1.0f ? 1 : per_cycle > 65535.0f ? 65535 : static_cast<uint16_t>(per_cycle + 0.5f);
+
+    sub_slot[slot].store(cfg);
+    net_client_set_subscribed(slot, true);
+    return cfg.decim;
+}
+
+void net_stream_unsubscribe(uint32_t client_id)
+{
+    const int slot = net_client_slot(client_id);
+    if (slot < 0)
+        return;
+    sub_slot[slot].store(sub_config{});
+    net_client_set_subscribed(slot, false);
+}
+
+void net_stream_start()
+{
+    static TaskHandle_t handle = nullptr;
+    if (handle)
+        return;
+    xTaskCreatePinnedToCore(stream_task, "stream", 6144, nullptr, 1, &handle, 1);
+}
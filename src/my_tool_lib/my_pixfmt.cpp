@@ -0,0 +1,114 @@
+#include <string.h>
+#include "my_pixfmt.h"
+
+namespace
+{
+// 亮度 r*527 + g*259 + b*527 拆成高低字节两张表，每像素两次查表一次加法
+// 高字节 rrrrrggg，低字节 gggbbbbb
+struct luma_lut
+{
+    uint16_t hi[256];
+    uint16_t lo[256];
+};
+
+constexpr luma_lut make_luma()
+{
+    luma_lut t{};
+    for (int i = 0; i < 256; ++i)
+    {
+        t.hi[i] = static_cast<uint16_t>((i >> 3) * 527 + ((i & 7) << 3) * 259);
+        t.lo[i] = static_cast<uint16_t>((i >> 5) * 259 + (i & 31) * 527);
+    }
+    return t;
+}
+
+constexpr luma_lut LUMA = make_luma();
+constexpr uint16_t LUMA_MAX = 31 * 527 + 63 * 259 + 31 * 527;
+
+// 旧实现为 (sum >> 6) > 512，等价于 sum >= 513 * 64
+constexpr uint16_t LUMA_THRESHOLD = 513 * 64;
+
+constexpr uint8_t BAYER4[4][4] = {
+    {0, 8, 2, 10},
+    {12, 4, 14, 6},
+    {3, 11, 1, 9},
+    {15, 7, 13, 5},
+};
+
+struct dither_lut
+{
+    uint16_t thr[4][4];
+};
+
+constexpr dither_lut make_dither()
+{
+    dither_lut t{};
+    for (int y = 0; y < 4; ++y)
+        for (int x = 0; x < 4; ++x)
+            t.thr[y][x] = static_cast<uint16_t>((2 * BAYER4[y][x] + 1) * static_cast<uint32_t>(LUMA_MAX) / 32);
+    return t;
+}
+
+constexpr dither_lut DITHER = make_dither();
+
+// 8x8 位矩阵转置（Hacker's Delight 7-3）：第 i 字节第 j 位 <-> 第 j 字节第 i 位
+inline uint64_t transpose8(uint64_t x)
+{
+    uint64_t t;
+    t = (x ^ (x >> 7)) & 0x00AA00AA00AA00AAULL;
+    x = x ^ t ^ (t << 7);
+    t = (x ^ (x >> 14)) & 0x0000CCCC0000CCCCULL;
+    x = x ^ t ^ (t << 14);
+    t = (x ^ (x >> 28)) & 0x00000000F0F0F0F0ULL;
+    x = x ^ t ^ (t << 28);
+    return x;
+}
+
+// 按行顺序读源图，每行把 1 位并入对应页字节；阈值模式下编译期去掉抖动表
+template <bool Dither>
+void rgb565_pages(const uint8_t *src, uint8_t *dst, uint16_t w, uint16_t h)
+{
+    memset(dst, 0, static_cast<size_t>(w) * h / 8);
+    for (uint16_t y = 0; y < h; ++y)
+    {
+        const uint8_t *px = src + static_cast<size_t>(y) * w * 2;
+        uint8_t *out = dst + (y / 8) * w;
+        const uint8_t bit = y & 7;
+        for (uint16_t x = 0; x < w; ++x, px += 2)
+        {
+            const uint16_t luma = LUMA.hi[px[1]] + LUMA.lo[px[0]];
+            const uint16_t thr = Dither ? DITHER.thr[y & 3][x & 3] : LUMA_THRESHOLD;
+            out[x] |= static_cast<uint8_t>(luma >= thr) << bit;
+        }
+    }
+}
+} // namespace
+
+void pix_mono_to_pages(const uint8_t *src, uint8_t *dst, uint16_t w, uint16_t h)
+{
+    const uint16_t stride = w / 8;
+    for (uint16_t page = 0; page < h / 8; ++page)
+    {
+        const uint8_t *rows = src + page * 8 * stride;
+        uint8_t *out = dst + page * w;
+        for (uint16_t bx = 0; bx < stride; ++bx)
+        {
+            // 第 r 行放第 r 字节；源字节 MSB 为最左列，转置后第 k 字节即第 7-k 列
+            uint64_t m = 0;
+            for (uint8_t r = 0; r < 8; ++r)
+                m |= static_cast<uint64_t>(rows[r * stride + bx]) << (8 * r);
+            m = transpose8(m);
+            for (uint8_t k = 0; k < 8; ++k)
+                out[bx * 8 + 7 - k] = static_cast<uint8_t>(m >> (8 * k));
+        }
+    }
+}
+
+void pix_rgb565_to_pages(const uint8_t *src, uint8_t *dst, uint16_t w, uint16_t h, bool dither)
+{
+    if (dither)
+        rgb565_pages<true>(src, dst, w, h);
+    else
+        rgb565_pages<false>(src, dst, w, h);
+}
+// 说明：外部图像（mono/rgb565）到 SSD1306 页格式的批量转换，取代逐像素 drawPixel
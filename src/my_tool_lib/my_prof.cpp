@@ -0,0 +1,133 @@
+#include <string.h>
+#include "my_prof.h"
+#include "my_hal.h"
+
+namespace
+{
+constexpr int STAGE_COUNT = static_cast<int>(ProfStage::Count);
+
+struct stage_hist
+{
+    uint32_t bins[PROF_BINS];
+    uint32_t count;
+    uint64_t sum;
+    uint32_t last;
+    uint32_t min;
+    uint32_t max;
+};
+
+stage_hist hist[STAGE_COUNT];
+volatile uint32_t overruns = 0;
+volatile bool reset_req = true;
+uint32_t cycles_per_bin = 0;
+
+void do_reset()
+{
+    memset(hist, 0, sizeof(hist));
+    for (stage_hist &h : hist)
+        h.min = UINT32_MAX;
+    overruns = 0;
+    cycles_per_bin = hal_cycles_per_us() * PROF_BIN_US;
+    if (cycles_per_bin == 0)
+        cycles_per_bin = 1;
+    reset_req = false;
+}
+
+float to_us(uint32_t cycles)
+{
+    const uint32_t per_us = hal_cycles_per_us();
+    return per_us ? static_cast<float>(cycles) / per_us : 0.0f;
+}
+
+// 从直方图取分位数，返回所在桶的上沿
+float percentile_us(const stage_hist &h, uint32_t count, float q)
+{
+    if (count == 0)
+        return 0.0f;
+    const uint32_t target = static_cast<uint32_t>(q * count);
+    uint32_t acc = 0;
+    for (int i = 0; i < PROF_BINS; ++i)
+    {
+        acc += h.bins[i];
+        if (acc > target)
+            return static_cast<float>((i + 1) * PROF_BIN_US);
+    }
+    return static_cast<float>(PROF_BINS * PROF_BIN_US);
+}
+} // namespace
+
+uint32_t prof_now()
+{
+    return hal_cycles();
+}
+
+void prof_add(ProfStage stage, uint32_t cycles)
+{
+    if (reset_req)
+        do_reset();
+
+    stage_hist &h = hist[static_cast<int>(stage)];
+    uint32_t bin = cycles / cycles_per_bin;
+    if (bin >= PROF_BINS)
+        bin = PROF_BINS - 1;
+    h.bins[bin]++;
+    h.count++;
+    h.sum += cycles;
+    h.last = cycles;
+    if (cycles < h.min)
+        h.min = cycles;
+    if (cycles > h.max)
+        h.max = cycles;
+}
+
+void prof_cycle_end(uint32_t busy_cycles, uint32_t budget_us)
+{
+    prof_add(ProfStage::Busy, busy_cycles);
+    if (busy_cycles > budget_us * hal_cycles_per_us())
+        overruns = overruns + 1;
+}
+
+prof_summary prof_get(ProfStage stage)
+{
+    prof_summary s{};
+    if (reset_req)
+        return s;
+    const stage_hist &h = hist[static_cast<int>(stage)];
+    // 读取侧可能与写入交错，仅用于观测，轻微不一致可接受
+    s.count = h.count;
+    if (s.count == 0)
+        return s;
+    s.last_us = to_us(h.last);
+    s.min_us = to_us(h.min);
+    s.max_us = to_us(h.max);
+    s.avg_us = to_us(static_cast<uint32_t>(h.sum / s.count));
+    s.p50_us = percentile_us(h, s.count, 0.50f);
+    s.p99_us = percentile_us(h, s.count, 0.99f);
+    return s;
+}
+
+uint32_t prof_overruns()
+{
+    return overruns;
+}
+
+const char *prof_stage_name(ProfStage stage)
+{
+    switch (stage)
+    {
+    case ProfStage::Imu: return "imu";
+    case ProfStage::Bat: return "bat";
+    case ProfStage::Motion: return "motion";
+    case ProfStage::Motor: return "motor";
+    case ProfStage::Busy: return "busy";
+    case ProfStage::Period: return "period";
+    case ProfStage::Cmd: return "cmd";
+    default: return "unknown";
+    }
+}
+
+void prof_reset()
+{
+    reset_req = true;
+}
+// 说明：控制周期分阶段耗时直方图（min/max/avg/p50/p99）与超时计数
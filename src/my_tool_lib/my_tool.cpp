@@ -1,5 +1,5 @@
-#include <Arduino.h>
 #include <math.h>
+#include <string.h>
 #include <cmath>
 #include "my_config.h"
 #include "my_tool.h"
@@ -32,6 +32,19 @@ float my_db(float value, float deadband)
     return new_value;
 }
 
+uint32_t my_crc32(const void *data, size_t len, uint32_t crc)
+{
+    const uint8_t *p = static_cast<const uint8_t *>(data);
+    crc = ~crc;
+    while (len--)
+    {
+        crc ^= *p++;
+        for (uint8_t k = 0; k < 8; ++k)
+            crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+    }
+    return ~crc;
+}
+
 static inline void rtrim_inplace(char *s)
 {
     char *e = s + strlen(s);
@@ -39,4 +52,4 @@ static inline void rtrim_inplace(char *s)
         --e;
     *e = '\0';
 }
-// 说明：通用小工具函数（限幅、死区、裁剪）供控制逻辑复用
+// 说明：通用小工具函数（限幅、死区、裁剪、CRC）供控制逻辑与持久化复用